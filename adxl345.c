@@ -25,6 +25,8 @@
 // =============================================================================
 // includes
 
+#include <stddef.h>
+#include <string.h>
 #include "adxl345.h"
 #include "adxl345_dev.h"
 #include "adxl345_err.h"
@@ -32,18 +34,98 @@
 // =============================================================================
 // local types and definitions
 
+// Fastest output data rate, in millihertz
+#define ADXL345_RATE_3200_MHZ 3200000UL
+
+#define REG_INFO_COUNT (sizeof(s_reg_info) / sizeof(s_reg_info[0]))
+
+// FIFO levels; FIFO_STATUS can report one more (the output registers)
+#define FIFO_DEPTH 32
+
+// Samples discarded after entering or leaving self-test
+#define SELF_TEST_SETTLE 4
+
+// Largest self-test average
+#define SELF_TEST_MAX_AVERAGE 1024
+
+// Self-test scale factors in percent at 2.0, 2.5, 3.3 and 3.6 V
+#define SELF_TEST_SUPPLY_POINTS 4
+
 // =============================================================================
 // local (forward) declarations
 
-static adxl345_err_t get_converted_reg(adxl345_t *adxl345, uint8_t reg_id,
-                                       float *val, float scale);
+static int32_t round_clamp(float val, int32_t lo, int32_t hi);
+
+static void decode_isample(const adxl345_data_regs_t *regs,
+                           adxl345_isample_t *sample);
+
+static adxl345_err_t self_test_run(adxl345_t *adxl345, uint16_t n_average,
+                                   adxl345_self_test_report_t *report);
+
+static adxl345_err_t self_test_average(adxl345_t *adxl345,
+                                       uint16_t n_average, int16_t mean[3]);
 
-static adxl345_err_t set_converted_reg(adxl345_t *adxl345, uint8_t reg_id,
-                                       float val, float scale);
+static int16_t self_test_scale(int16_t limit, const uint8_t *pct,
+                               uint16_t supply_mv);
 
 // =============================================================================
 // local storage
 
+// Indexed by address: DEVID first, then 0x1D..0x39
+static const adxl345_reg_info_t s_reg_info[] = {
+    {ADXL345_REG_DEVID, ADXL345_ACCESS_R, ADXL345_DEVICE_ID, 0},
+    {ADXL345_REG_THRESH_TAP, ADXL345_ACCESS_RW, 0,
+     ADXL345_REG_THRESH_TAP_SCALE},
+    {ADXL345_REG_OFSX, ADXL345_ACCESS_RW | ADXL345_ACCESS_SIGNED, 0,
+     ADXL345_OFSx_SCALE},
+    {ADXL345_REG_OFSY, ADXL345_ACCESS_RW | ADXL345_ACCESS_SIGNED, 0,
+     ADXL345_OFSx_SCALE},
+    {ADXL345_REG_OFSZ, ADXL345_ACCESS_RW | ADXL345_ACCESS_SIGNED, 0,
+     ADXL345_OFSx_SCALE},
+    {ADXL345_REG_DUR, ADXL345_ACCESS_RW, 0, ADXL345_DUR_SCALE},
+    {ADXL345_REG_LATENT, ADXL345_ACCESS_RW, 0, ADXL345_LATENT_SCALE},
+    {ADXL345_REG_WINDOW, ADXL345_ACCESS_RW, 0, ADXL345_WINDOW_SCALE},
+    {ADXL345_REG_THRESH_ACT, ADXL345_ACCESS_RW, 0, ADXL345_THRESH_ACT_SCALE},
+    {ADXL345_REG_THRESH_INACT, ADXL345_ACCESS_RW, 0,
+     ADXL345_THRESH_INACT_SCALE},
+    {ADXL345_REG_TIME_INACT, ADXL345_ACCESS_RW, 0, ADXL345_TIME_INACT_SCALE},
+    {ADXL345_REG_ACT_INACT_CTL, ADXL345_ACCESS_RW, 0, 0},
+    {ADXL345_REG_THRESH_FF, ADXL345_ACCESS_RW, 0, ADXL345_THRESH_FF_SCALE},
+    {ADXL345_REG_TIME_FF, ADXL345_ACCESS_RW, 0, ADXL345_TIME_FF_SCALE},
+    {ADXL345_REG_TAP_AXES, ADXL345_ACCESS_RW, 0, 0},
+    {ADXL345_REG_ACT_TAP_STATUS, ADXL345_ACCESS_R, 0, 0},
+    {ADXL345_REG_BW_RATE, ADXL345_ACCESS_RW, ADXL345_RATE_100, 0},
+    {ADXL345_REG_POWER_CTL, ADXL345_ACCESS_RW, 0, 0},
+    {ADXL345_REG_INT_ENABLE, ADXL345_ACCESS_RW, 0, 0},
+    {ADXL345_REG_INT_MAP, ADXL345_ACCESS_RW, 0, 0},
+    {ADXL345_REG_INT_SOURCE, ADXL345_ACCESS_R, ADXL345_WATERMARK_INT, 0},
+    {ADXL345_REG_DATA_FORMAT, ADXL345_ACCESS_RW, 0, 0},
+    {ADXL345_REG_DATAX0, ADXL345_ACCESS_R, 0, 0},
+    {ADXL345_REG_DATAX1, ADXL345_ACCESS_R, 0, 0},
+    {ADXL345_REG_DATAY0, ADXL345_ACCESS_R, 0, 0},
+    {ADXL345_REG_DATAY1, ADXL345_ACCESS_R, 0, 0},
+    {ADXL345_REG_DATAZ0, ADXL345_ACCESS_R, 0, 0},
+    {ADXL345_REG_DATAZ1, ADXL345_ACCESS_R, 0, 0},
+    {ADXL345_REG_FIFO_CTL, ADXL345_ACCESS_RW, 0, 0},
+    {ADXL345_REG_FIFO_STATUS, ADXL345_ACCESS_R, 0, 0},
+};
+
+// one entry for DEVID and one for every address from THRESH_TAP to FIFO_STATUS
+typedef char reg_info_count_check[(REG_INFO_COUNT ==
+                                   1 + (ADXL345_REG_FIFO_STATUS -
+                                        ADXL345_REG_THRESH_TAP + 1))
+                                      ? 1
+                                      : -1];
+
+static const uint16_t s_self_test_mv[SELF_TEST_SUPPLY_POINTS] = {2000, 2500,
+                                                                 3300, 3600};
+
+static const uint8_t s_self_test_xy_pct[SELF_TEST_SUPPLY_POINTS] = {64, 100,
+                                                                    177, 211};
+
+static const uint8_t s_self_test_z_pct[SELF_TEST_SUPPLY_POINTS] = {80, 100,
+                                                                   147, 164};
+
 // =============================================================================
 // public code
 
@@ -78,7 +160,7 @@ adxl345_err_t adxl345_reset(adxl345_t *adxl345) {
     uint8_t reg;
     adxl345_data_regs_t regs;
 
-    err = adxl345_get_int_source_reg(adxl345, &reg);
+    err = adxl345_get_reg(adxl345, ADXL345_REG_INT_SOURCE, &reg);
     if (err != ADXL345_ERR_NONE) return err;
 
     // stop reading when DATA_READY bit goes false.
@@ -89,62 +171,13 @@ adxl345_err_t adxl345_reset(adxl345_t *adxl345) {
     if (err != ADXL345_ERR_NONE) return err;
   }
 
-  err = adxl345_write_reg(adxl345, ADXL345_REG_THRESH_TAP, 0, true);
-  if (err != ADXL345_ERR_NONE) return err;
-
-  err = adxl345_write_reg(adxl345, ADXL345_REG_OFSX, 0, true);
-  if (err != ADXL345_ERR_NONE) return err;
-
-  err = adxl345_write_reg(adxl345, ADXL345_REG_OFSY, 0, true);
-  if (err != ADXL345_ERR_NONE) return err;
-
-  err = adxl345_write_reg(adxl345, ADXL345_REG_OFSZ, 0, true);
-  if (err != ADXL345_ERR_NONE) return err;
-
-  err = adxl345_write_reg(adxl345, ADXL345_REG_DUR, 0, true);
-  if (err != ADXL345_ERR_NONE) return err;
-
-  err = adxl345_write_reg(adxl345, ADXL345_REG_LATENT, 0, true);
-  if (err != ADXL345_ERR_NONE) return err;
-
-  err = adxl345_write_reg(adxl345, ADXL345_REG_WINDOW, 0, true);
-  if (err != ADXL345_ERR_NONE) return err;
-
-  err = adxl345_write_reg(adxl345, ADXL345_REG_THRESH_ACT, 0, true);
-  if (err != ADXL345_ERR_NONE) return err;
-
-  err = adxl345_write_reg(adxl345, ADXL345_REG_THRESH_INACT, 0, true);
-  if (err != ADXL345_ERR_NONE) return err;
-
-  err = adxl345_write_reg(adxl345, ADXL345_REG_TIME_INACT, 0, true);
-  if (err != ADXL345_ERR_NONE) return err;
-
-  err = adxl345_write_reg(adxl345, ADXL345_REG_ACT_INACT_CTL, 0, true);
-  if (err != ADXL345_ERR_NONE) return err;
-
-  err = adxl345_write_reg(adxl345, ADXL345_REG_THRESH_FF, 0, true);
-  if (err != ADXL345_ERR_NONE) return err;
-
-  err = adxl345_write_reg(adxl345, ADXL345_REG_TIME_FF, 0, true);
-  if (err != ADXL345_ERR_NONE) return err;
-
-  err = adxl345_write_reg(adxl345, ADXL345_REG_TAP_AXES, 0, true);
-  if (err != ADXL345_ERR_NONE) return err;
-
-  err = adxl345_write_reg(adxl345, ADXL345_REG_BW_RATE, 0x0A, true); // !!
-  if (err != ADXL345_ERR_NONE) return err;
-
-  err = adxl345_write_reg(adxl345, ADXL345_REG_INT_ENABLE, 0, true);
-  if (err != ADXL345_ERR_NONE) return err;
-
-  err = adxl345_write_reg(adxl345, ADXL345_REG_INT_MAP, 0, true);
-  if (err != ADXL345_ERR_NONE) return err;
-
-  err = adxl345_write_reg(adxl345, ADXL345_REG_DATA_FORMAT, 0, true);
-  if (err != ADXL345_ERR_NONE) return err;
-
-  err = adxl345_write_reg(adxl345, ADXL345_REG_FIFO_CTL, 0, true);
-  if (err != ADXL345_ERR_NONE) return err;
+  // then restore every writable register to its power-on value
+  for (uint8_t i = 0; i < REG_INFO_COUNT; i++) {
+    const adxl345_reg_info_t *info = &s_reg_info[i];
+    if (!(info->flags & ADXL345_ACCESS_W)) continue;
+    err = adxl345_write_reg(adxl345, info->reg, info->reset, true);
+    if (err != ADXL345_ERR_NONE) return err;
+  }
 
   return err;
 }
@@ -166,182 +199,92 @@ adxl345_err_t adxl345_write_reg(adxl345_t *adxl345, uint8_t reg_id, uint8_t val,
   return err;
 }
 
-// ==========================================
-// low-level register access
-
-adxl345_err_t adxl345_get_devid_reg(adxl345_t *adxl345, uint8_t *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_DEVID, val);
-}
-
-adxl345_err_t adxl345_get_thresh_tap_reg(adxl345_t *adxl345, uint8_t *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_THRESH_TAP, val);
-}
-
-adxl345_err_t adxl345_set_thresh_tap_reg(adxl345_t *adxl345, uint8_t val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_THRESH_TAP, val);
-}
-
-adxl345_err_t adxl345_get_ofsx_reg(adxl345_t *adxl345, uint8_t *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_OFSX, val);
-}
-
-adxl345_err_t adxl345_set_ofsx_reg(adxl345_t *adxl345, uint8_t val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_OFSX, val);
-}
-
-adxl345_err_t adxl345_get_ofsy_reg(adxl345_t *adxl345, uint8_t *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_OFSY, val);
-}
-
-adxl345_err_t adxl345_set_ofsy_reg(adxl345_t *adxl345, uint8_t val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_OFSX, val);
-}
-
-adxl345_err_t adxl345_get_ofsz_reg(adxl345_t *adxl345, uint8_t *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_OFSZ, val);
+adxl345_err_t adxl345_read_reg(adxl345_t *adxl345, uint8_t reg_id,
+                               uint8_t *val) {
+  return adxl345_dev_read_reg(adxl345->dev, reg_id, val);
 }
 
-adxl345_err_t adxl345_set_ofsz_reg(adxl345_t *adxl345, uint8_t val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_OFSZ, val);
+adxl345_err_t adxl345_read_regs(adxl345_t *adxl345, uint8_t reg_id,
+                                uint8_t *dst, uint8_t n) {
+  return adxl345_dev_read_regs(adxl345->dev, reg_id, dst, n);
 }
 
-adxl345_err_t adxl345_get_dur_reg(adxl345_t *adxl345, uint8_t *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_DUR, val);
-}
-
-adxl345_err_t adxl345_set_dur_reg(adxl345_t *adxl345, uint8_t val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_DUR, val);
-}
-
-adxl345_err_t adxl345_get_latency_reg(adxl345_t *adxl345, uint8_t *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_LATENT, val);
-}
-
-adxl345_err_t adxl345_set_latency_reg(adxl345_t *adxl345, uint8_t val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_LATENT, val);
-}
-
-adxl345_err_t adxl345_get_window_reg(adxl345_t *adxl345, uint8_t *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_WINDOW, val);
-}
-
-adxl345_err_t adxl345_set_window_reg(adxl345_t *adxl345, uint8_t val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_WINDOW, val);
-}
-
-adxl345_err_t adxl345_get_thresh_act_reg(adxl345_t *adxl345, uint8_t *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_THRESH_ACT, val);
-}
-
-adxl345_err_t adxl345_set_thresh_act_reg(adxl345_t *adxl345, uint8_t val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_THRESH_ACT, val);
-}
-
-adxl345_err_t adxl345_get_thresh_inact_reg(adxl345_t *adxl345, uint8_t *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_THRESH_INACT, val);
-}
-
-adxl345_err_t adxl345_set_thresh_inact_reg(adxl345_t *adxl345, uint8_t val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_THRESH_INACT, val);
-}
-
-adxl345_err_t adxl345_get_time_inact_reg(adxl345_t *adxl345, uint8_t *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_TIME_INACT, val);
-}
-
-adxl345_err_t adxl345_set_time_inact_reg(adxl345_t *adxl345, uint8_t val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_TIME_INACT, val);
-}
-
-adxl345_err_t adxl345_get_act_inact_ctl_reg(adxl345_t *adxl345,
-                                            adxl345_act_inact_ctl_reg *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_ACT_INACT_CTL, val);
-}
-
-adxl345_err_t adxl345_set_act_inact_ctl_reg(adxl345_t *adxl345,
-                                            adxl345_act_inact_ctl_reg val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_ACT_INACT_CTL, val);
-}
-
-adxl345_err_t adxl345_get_thresh_ff_reg(adxl345_t *adxl345, uint8_t *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_THRESH_FF, val);
-}
-
-adxl345_err_t adxl345_set_thresh_ff_reg(adxl345_t *adxl345, uint8_t val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_THRESH_FF, val);
-}
+adxl345_err_t adxl345_update_reg(adxl345_t *adxl345, uint8_t reg_id,
+                                 uint8_t mask, uint8_t val) {
+  uint8_t reg;
+  adxl345_err_t err;
 
-adxl345_err_t adxl345_get_time_ff_reg(adxl345_t *adxl345, uint8_t *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_TIME_FF, val);
-}
+  err = adxl345_dev_read_reg(adxl345->dev, reg_id, &reg);
+  if (err != ADXL345_ERR_NONE) return err;
 
-adxl345_err_t adxl345_set_time_ff_reg(adxl345_t *adxl345, uint8_t val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_TIME_FF, val);
+  reg = (reg & ~mask) | (val & mask);
+  return adxl345_dev_write_reg(adxl345->dev, reg_id, reg);
 }
 
-adxl345_err_t adxl345_get_tap_axes_reg(adxl345_t *adxl345,
-                                       adxl345_tap_axes_reg *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_TAP_AXES, val);
-}
+// ==========================================
+// low-level register access
 
-adxl345_err_t adxl345_set_tap_axes_reg(adxl345_t *adxl345,
-                                       adxl345_tap_axes_reg val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_TAP_AXES, val);
+const adxl345_reg_info_t *adxl345_reg_info(uint8_t reg_id) {
+  if (reg_id == ADXL345_REG_DEVID) return &s_reg_info[0];
+  if ((reg_id < ADXL345_REG_THRESH_TAP) || (reg_id > ADXL345_REG_FIFO_STATUS)) {
+    return NULL;
+  }
+  return &s_reg_info[reg_id - ADXL345_REG_THRESH_TAP + 1];
 }
 
-adxl345_err_t adxl345_get_bw_rate_reg(adxl345_t *adxl345,
-                                      adxl345_bw_rate_reg *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_BW_RATE, val);
-}
+adxl345_err_t adxl345_get_reg(adxl345_t *adxl345, uint8_t reg_id,
+                              uint8_t *val) {
+  const adxl345_reg_info_t *info = adxl345_reg_info(reg_id);
 
-adxl345_err_t adxl345_set_bw_rate_reg(adxl345_t *adxl345,
-                                      adxl345_bw_rate_reg val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_BW_RATE, val);
+  if ((info == NULL) || !(info->flags & ADXL345_ACCESS_R)) {
+    return ADXL345_ERR_PARAM;
+  }
+  return adxl345_dev_read_reg(adxl345->dev, reg_id, val);
 }
 
-adxl345_err_t adxl345_get_power_ctl_reg(adxl345_t *adxl345,
-                                        adxl345_power_ctl_reg *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_POWER_CTL, val);
-}
+adxl345_err_t adxl345_set_reg(adxl345_t *adxl345, uint8_t reg_id,
+                              uint8_t val) {
+  const adxl345_reg_info_t *info = adxl345_reg_info(reg_id);
 
-adxl345_err_t adxl345_set_power_ctl_reg(adxl345_t *adxl345,
-                                        adxl345_power_ctl_reg val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_POWER_CTL, val);
+  if ((info == NULL) || !(info->flags & ADXL345_ACCESS_W)) {
+    return ADXL345_ERR_PARAM;
+  }
+  return adxl345_dev_write_reg(adxl345->dev, reg_id, val);
 }
 
-adxl345_err_t adxl345_get_int_enable_reg(adxl345_t *adxl345,
-                                         adxl345_interrupt_reg *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_INT_ENABLE, val);
-}
+adxl345_err_t adxl345_get_scaled(adxl345_t *adxl345, uint8_t reg_id,
+                                 float *val) {
+  const adxl345_reg_info_t *info = adxl345_reg_info(reg_id);
+  uint8_t reg;
+  adxl345_err_t err;
 
-adxl345_err_t adxl345_set_int_enable_reg(adxl345_t *adxl345,
-                                         adxl345_interrupt_reg val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_INT_ENABLE, val);
-}
+  *val = 0.0;
+  if ((info == NULL) || (info->scale == 0)) return ADXL345_ERR_PARAM;
 
-adxl345_err_t adxl345_get_int_map_reg(adxl345_t *adxl345,
-                                      adxl345_interrupt_reg *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_INT_MAP, val);
-}
+  err = adxl345_get_reg(adxl345, reg_id, &reg);
+  if (err != ADXL345_ERR_NONE) return err;
 
-adxl345_err_t adxl345_set_int_map_reg(adxl345_t *adxl345,
-                                      adxl345_interrupt_reg val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_INT_MAP, val);
+  if (info->flags & ADXL345_ACCESS_SIGNED) {
+    *val = (int8_t)reg * info->scale;
+  } else {
+    *val = reg * info->scale;
+  }
+  return ADXL345_ERR_NONE;
 }
 
-adxl345_err_t adxl345_get_int_source_reg(adxl345_t *adxl345,
-                                         adxl345_interrupt_reg *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_INT_SOURCE, val);
-}
+adxl345_err_t adxl345_set_scaled(adxl345_t *adxl345, uint8_t reg_id,
+                                 float val) {
+  const adxl345_reg_info_t *info = adxl345_reg_info(reg_id);
+  int32_t reg;
 
-adxl345_err_t adxl345_get_data_format_reg(adxl345_t *adxl345,
-                                          adxl345_data_format_reg *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_DATA_FORMAT, val);
-}
+  if ((info == NULL) || (info->scale == 0)) return ADXL345_ERR_PARAM;
 
-adxl345_err_t adxl345_set_data_format_reg(adxl345_t *adxl345,
-                                          adxl345_data_format_reg val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_DATA_FORMAT, val);
+  if (info->flags & ADXL345_ACCESS_SIGNED) {
+    reg = round_clamp(val / info->scale, INT8_MIN, INT8_MAX);
+  } else {
+    reg = round_clamp(val / info->scale, 0, UINT8_MAX);
+  }
+  return adxl345_set_reg(adxl345, reg_id, (uint8_t)reg);
 }
 
 adxl345_err_t adxl345_get_data_regs(adxl345_t *adxl345,
@@ -350,21 +293,6 @@ adxl345_err_t adxl345_get_data_regs(adxl345_t *adxl345,
                                sizeof(adxl345_data_regs_t));
 }
 
-adxl345_err_t adxl345_get_fifo_ctl_reg(adxl345_t *adxl345,
-                                       adxl345_fifo_mode_reg *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_FIFO_CTL, val);
-}
-
-adxl345_err_t adxl345_set_fifo_ctl_reg(adxl345_t *adxl345,
-                                       adxl345_fifo_mode_reg val) {
-  return adxl345_dev_write_reg(adxl345->dev, ADXL345_REG_FIFO_CTL, val);
-}
-
-adxl345_err_t adxl345_get_fifo_status_reg(adxl345_t *adxl345,
-                                          adxl345_fifo_status_reg *val) {
-  return adxl345_dev_read_reg(adxl345->dev, ADXL345_REG_FIFO_STATUS, val);
-}
-
 // ==========================================
 // higher level functions.  In the functions below,
 // _g stands for gravity and _s stands for seconds.
@@ -376,7 +304,7 @@ adxl345_err_t adxl345_start(adxl345_t *adxl345) {
   uint8_t reg;
   adxl345_err_t err;
 
-  err = adxl345_get_power_ctl_reg(adxl345, &reg);
+  err = adxl345_get_reg(adxl345, ADXL345_REG_POWER_CTL, &reg);
   if (err != ADXL345_ERR_NONE) return err;
 
   err = adxl345_set_power_ctl_reg(adxl345, reg | ADXL345_MEASURE);
@@ -390,7 +318,7 @@ adxl345_err_t adxl345_stop(adxl345_t *adxl345) {
   uint8_t reg;
   adxl345_err_t err;
 
-  err = adxl345_get_power_ctl_reg(adxl345, &reg);
+  err = adxl345_get_reg(adxl345, ADXL345_REG_POWER_CTL, &reg);
   if (err != ADXL345_ERR_NONE) return err;
 
   err = adxl345_set_power_ctl_reg(adxl345, reg & ~ADXL345_MEASURE);
@@ -404,7 +332,7 @@ adxl345_err_t adxl345_is_sample_available(adxl345_t *adxl345, bool *is_sample_av
   uint8_t reg;
   adxl345_err_t err;
 
-  err = adxl345_get_int_source_reg(adxl345, &reg);
+  err = adxl345_get_reg(adxl345, ADXL345_REG_INT_SOURCE, &reg);
   if (err == ADXL345_ERR_NONE) {
     *is_sample_available = (reg & ADXL345_DATA_READY_INT) ? true : false;
   } else {
@@ -413,178 +341,344 @@ adxl345_err_t adxl345_is_sample_available(adxl345_t *adxl345, bool *is_sample_av
   return err;
 }
 
-adxl345_err_t adxl345_get_tap_thresh_g(adxl345_t *adxl345, float *val) {
-  return get_converted_reg(adxl345, ADXL345_REG_THRESH_TAP, val,
-                           ADXL345_REG_THRESH_TAP_SCALE);
+int16_t adxl345_format_full_scale(uint8_t data_format) {
+  uint8_t range = data_format & ADXL345_RANGE_16G;
+  if (data_format & ADXL345_FULL_RES) {
+    return (int16_t)((512 << range) - 1);
+  }
+  return 511;
 }
 
-adxl345_err_t adxl345_set_tap_thresh_g(adxl345_t *adxl345, float val) {
-  return set_converted_reg(adxl345, ADXL345_REG_THRESH_TAP, val,
-                           ADXL345_REG_THRESH_TAP_SCALE);
+uint8_t adxl345_format_shift(uint8_t data_format) {
+  if (data_format & ADXL345_FULL_RES) {
+    return 0;
+  }
+  return data_format & ADXL345_RANGE_16G;
 }
 
-adxl345_err_t adxl345_get_ofsx_g(adxl345_t *adxl345, float *val) {
-  return get_converted_reg(adxl345, ADXL345_REG_OFSX, val, ADXL345_OFSx_SCALE);
+uint32_t adxl345_rate_to_mhz(uint8_t bw_rate) {
+  return ADXL345_RATE_3200_MHZ >> (ADXL345_RATE_3200 - (bw_rate & 0x0F));
 }
 
-adxl345_err_t adxl345_set_ofsx_g(adxl345_t *adxl345, float val) {
-  return set_converted_reg(adxl345, ADXL345_REG_OFSX, val, ADXL345_OFSx_SCALE);
+adxl345_err_t adxl345_get_rate_mhz(adxl345_t *adxl345, uint32_t *mhz) {
+  uint8_t reg;
+  adxl345_err_t err = adxl345_read_reg(adxl345, ADXL345_REG_BW_RATE, &reg);
+  *mhz = (err == ADXL345_ERR_NONE) ? adxl345_rate_to_mhz(reg) : 0;
+  return err;
 }
 
-adxl345_err_t adxl345_get_ofsy_g(adxl345_t *adxl345, float *val) {
-  return get_converted_reg(adxl345, ADXL345_REG_OFSY, val, ADXL345_OFSx_SCALE);
+adxl345_err_t adxl345_available_samples(adxl345_t *adxl345, uint8_t *val) {
+  uint8_t reg;
+  adxl345_err_t err = adxl345_get_reg(adxl345, ADXL345_REG_FIFO_STATUS, &reg);
+  *val = (err == ADXL345_ERR_NONE) ? reg & ADXL345_FIFO_ENTRIES_MASK : 0;
+  return err;
 }
 
-adxl345_err_t adxl345_set_ofsy_g(adxl345_t *adxl345, float val) {
-  return set_converted_reg(adxl345, ADXL345_REG_OFSY, val, ADXL345_OFSx_SCALE);
-}
+/** @brief Read an x, y, z sample frame.
+ */
+adxl345_err_t adxl345_get_isample(adxl345_t *adxl345,
+                                  adxl345_isample_t *sample) {
+  adxl345_data_regs_t regs;
+  adxl345_err_t err;
 
-adxl345_err_t adxl345_get_ofsz_g(adxl345_t *adxl345, float *val) {
-  return get_converted_reg(adxl345, ADXL345_REG_OFSZ, val, ADXL345_OFSx_SCALE);
-}
+  err = adxl345_get_data_regs(adxl345, &regs);
+  if (err != ADXL345_ERR_NONE) return err;
 
-adxl345_err_t adxl345_set_ofsz_g(adxl345_t *adxl345, float val) {
-  return set_converted_reg(adxl345, ADXL345_REG_OFSZ, val, ADXL345_OFSx_SCALE);
-}
+  decode_isample(&regs, sample);
 
-adxl345_err_t adxl345_get_dur_g(adxl345_t *adxl345, float *val) {
-  return get_converted_reg(adxl345, ADXL345_REG_DUR, val, ADXL345_DUR_SCALE);
+  return ADXL345_ERR_NONE;
 }
 
-adxl345_err_t adxl345_set_dur_g(adxl345_t *adxl345, float val) {
-  return set_converted_reg(adxl345, ADXL345_REG_DUR, val, ADXL345_DUR_SCALE);
-}
+adxl345_err_t adxl345_get_isamples(adxl345_t *adxl345,
+                                   adxl345_isample_t *samples, uint8_t n) {
+  adxl345_data_regs_t regs;
+  adxl345_err_t err;
 
-adxl345_err_t adxl345_get_latency_s(adxl345_t *adxl345, float *val) {
-  return get_converted_reg(adxl345, ADXL345_REG_LATENT, val,
-                           ADXL345_LATENT_SCALE);
-}
+  for (uint8_t i = 0; i < n; i++) {
+    err = adxl345_get_data_regs(adxl345, &regs);
+    if (err != ADXL345_ERR_NONE) return err;
+    decode_isample(&regs, &samples[i]);
+  }
 
-adxl345_err_t adxl345_set_latency_s(adxl345_t *adxl345, float val) {
-  return set_converted_reg(adxl345, ADXL345_REG_LATENT, val,
-                           ADXL345_LATENT_SCALE);
+  return ADXL345_ERR_NONE;
 }
 
-adxl345_err_t adxl345_get_window_s(adxl345_t *adxl345, float *val) {
-  return get_converted_reg(adxl345, ADXL345_REG_WINDOW, val,
-                           ADXL345_WINDOW_SCALE);
-}
+/** @brief Read an x, y, z sample frame.
+ */
+adxl345_err_t adxl345_get_fsample(adxl345_t *adxl345,
+                                  adxl345_fsample_t *sample) {
+  adxl345_data_regs_t regs;
+  adxl345_err_t err;
 
-adxl345_err_t adxl345_set_window_s(adxl345_t *adxl345, float val) {
-  return set_converted_reg(adxl345, ADXL345_REG_WINDOW, val,
-                           ADXL345_WINDOW_SCALE);
-}
+  err = adxl345_get_data_regs(adxl345, &regs);
+  if (err != ADXL345_ERR_NONE) return err;
 
-adxl345_err_t adxl345_get_thresh_act_g(adxl345_t *adxl345, float *val) {
-  return get_converted_reg(adxl345, ADXL345_REG_THRESH_ACT, val,
-                           ADXL345_THRESH_ACT_SCALE);
-}
+  // Using default values:
+  //   x1:x0 is a 16 bit signed value with 10 bits of resolution.
+  //   Full scale is 2^9 = 512 corresponding to 2g
+  //   This can change with sensitivity settings, packing mode, etc.
+  sample->x = (int16_t)((regs.x1 << 8) | regs.x0) * ADXL345_2G_SCALE;
+  sample->y = (int16_t)((regs.y1 << 8) | regs.y0) * ADXL345_2G_SCALE;
+  sample->z = (int16_t)((regs.z1 << 8) | regs.z0) * ADXL345_2G_SCALE;
 
-adxl345_err_t adxl345_set_thresh_act_g(adxl345_t *adxl345, float val) {
-  return set_converted_reg(adxl345, ADXL345_REG_THRESH_ACT, val,
-                           ADXL345_THRESH_ACT_SCALE);
+  return ADXL345_ERR_NONE;
 }
 
-adxl345_err_t adxl345_get_thresh_inact_g(adxl345_t *adxl345, float *val) {
-  return get_converted_reg(adxl345, ADXL345_REG_THRESH_INACT, val,
-                           ADXL345_THRESH_INACT_SCALE);
-}
+adxl345_err_t adxl345_self_test(adxl345_t *adxl345, uint16_t supply_mv,
+                                uint16_t n_average,
+                                adxl345_self_test_report_t *report) {
+  static const int16_t limits[3][2] = {
+      {ADXL345_SELF_TEST_X_MIN, ADXL345_SELF_TEST_X_MAX},
+      {ADXL345_SELF_TEST_Y_MIN, ADXL345_SELF_TEST_Y_MAX},
+      {ADXL345_SELF_TEST_Z_MIN, ADXL345_SELF_TEST_Z_MAX},
+  };
+  uint8_t bw_rate, data_format, power_ctl, fifo_ctl;
+  adxl345_err_t err, restore_err;
+
+  if ((supply_mv < ADXL345_SELF_TEST_MIN_MV) ||
+      (supply_mv > ADXL345_SELF_TEST_MAX_MV) || (n_average == 0) ||
+      (n_average > SELF_TEST_MAX_AVERAGE)) {
+    return ADXL345_ERR_PARAM;
+  }
 
-adxl345_err_t adxl345_set_thresh_inact_g(adxl345_t *adxl345, float val) {
-  return set_converted_reg(adxl345, ADXL345_REG_THRESH_INACT, val,
-                           ADXL345_THRESH_INACT_SCALE);
-}
+  err = adxl345_read_reg(adxl345, ADXL345_REG_BW_RATE, &bw_rate);
+  if (err != ADXL345_ERR_NONE) return err;
+  err = adxl345_read_reg(adxl345, ADXL345_REG_DATA_FORMAT, &data_format);
+  if (err != ADXL345_ERR_NONE) return err;
+  err = adxl345_read_reg(adxl345, ADXL345_REG_POWER_CTL, &power_ctl);
+  if (err != ADXL345_ERR_NONE) return err;
+  err = adxl345_read_reg(adxl345, ADXL345_REG_FIFO_CTL, &fifo_ctl);
+  if (err != ADXL345_ERR_NONE) return err;
 
-adxl345_err_t adxl345_get_time_inact_s(adxl345_t *adxl345, float *val) {
-  return get_converted_reg(adxl345, ADXL345_REG_TIME_INACT, val,
-                           ADXL345_TIME_INACT_SCALE);
+  err = adxl345_write_reg(adxl345, ADXL345_REG_BW_RATE, ADXL345_RATE_800,
+                          true);
+  if (err == ADXL345_ERR_NONE) {
+    // keep the interface bits, which the host depends on
+    err = adxl345_write_reg(
+        adxl345, ADXL345_REG_DATA_FORMAT,
+        (data_format & (ADXL345_3_WIRE_SPI | ADXL345_INT_INVERT)) |
+            ADXL345_FULL_RES | ADXL345_RANGE_16G,
+        true);
+  }
+  if (err == ADXL345_ERR_NONE) {
+    err = adxl345_write_reg(adxl345, ADXL345_REG_POWER_CTL, ADXL345_MEASURE,
+                            true);
+  }
+  if (err == ADXL345_ERR_NONE) {
+    err = self_test_run(adxl345, n_average, report);
+  }
+
+  // put everything back even if the test itself failed
+  restore_err = adxl345_write_reg(adxl345, ADXL345_REG_FIFO_CTL,
+                                  ADXL345_FIFO_MODE_BYPASS, false);
+  if (restore_err == ADXL345_ERR_NONE) {
+    restore_err = adxl345_write_reg(adxl345, ADXL345_REG_DATA_FORMAT,
+                                    data_format, true);
+  }
+  if (restore_err == ADXL345_ERR_NONE) {
+    restore_err =
+        adxl345_write_reg(adxl345, ADXL345_REG_BW_RATE, bw_rate, true);
+  }
+  if (restore_err == ADXL345_ERR_NONE) {
+    restore_err =
+        adxl345_write_reg(adxl345, ADXL345_REG_POWER_CTL, power_ctl, true);
+  }
+  if (restore_err == ADXL345_ERR_NONE) {
+    restore_err =
+        adxl345_write_reg(adxl345, ADXL345_REG_FIFO_CTL, fifo_ctl, true);
+  }
+  if (err != ADXL345_ERR_NONE) return err;
+  if (restore_err != ADXL345_ERR_NONE) return restore_err;
+
+  report->failed = 0;
+  for (int axis = 0; axis < 3; axis++) {
+    const uint8_t *pct = (axis == 2) ? s_self_test_z_pct : s_self_test_xy_pct;
+    report->delta[axis] = report->on[axis] - report->off[axis];
+    report->min[axis] = self_test_scale(limits[axis][0], pct, supply_mv);
+    report->max[axis] = self_test_scale(limits[axis][1], pct, supply_mv);
+    if ((report->delta[axis] < report->min[axis]) ||
+        (report->delta[axis] > report->max[axis])) {
+      report->failed |= 1 << axis;
+    }
+  }
+  report->pass = (report->failed == 0);
+  return ADXL345_ERR_NONE;
 }
 
-adxl345_err_t adxl345_set_time_inact_s(adxl345_t *adxl345, float val) {
-  return set_converted_reg(adxl345, ADXL345_REG_TIME_INACT, val,
-                           ADXL345_TIME_INACT_SCALE);
+adxl345_err_t adxl345_snapshot(adxl345_t *adxl345,
+                               adxl345_snapshot_mode_t mode,
+                               adxl345_snapshot_t *snap) {
+  uint8_t *regs = (uint8_t *)snap;
+  adxl345_err_t err;
+
+  if (mode == ADXL345_SNAPSHOT_ALL) {
+    return adxl345_dev_read_regs(adxl345->dev, ADXL345_REG_THRESH_TAP, regs,
+                                 sizeof(adxl345_snapshot_t));
+  }
+
+  err = adxl345_dev_read_regs(adxl345->dev, ADXL345_REG_THRESH_TAP, regs,
+                              ADXL345_REG_DATAX0 - ADXL345_REG_THRESH_TAP);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  memset(&snap->data, 0, sizeof(snap->data));
+  return adxl345_dev_read_regs(adxl345->dev, ADXL345_REG_FIFO_CTL,
+                               &regs[ADXL345_REG_FIFO_CTL -
+                                     ADXL345_REG_THRESH_TAP],
+                               2);
 }
 
-adxl345_err_t adxl345_get_thresh_ff_g(adxl345_t *adxl345, float *val) {
-  return get_converted_reg(adxl345, ADXL345_REG_THRESH_FF, val,
-                           ADXL345_THRESH_FF_SCALE);
+uint32_t adxl345_snapshot_diff(const adxl345_snapshot_t *a,
+                               const adxl345_snapshot_t *b) {
+  const uint8_t *ra = (const uint8_t *)a;
+  const uint8_t *rb = (const uint8_t *)b;
+  uint32_t mask = 0;
+
+  for (uint8_t i = 0; i < sizeof(adxl345_snapshot_t); i++) {
+    if (ra[i] != rb[i]) mask |= 1UL << i;
+  }
+  return mask;
 }
 
-adxl345_err_t adxl345_set_thresh_ff_g(adxl345_t *adxl345, float val) {
-  return set_converted_reg(adxl345, ADXL345_REG_THRESH_FF, val,
-                           ADXL345_THRESH_FF_SCALE);
+void adxl345_snapshot_reset(adxl345_snapshot_t *snap) {
+  uint8_t *regs = (uint8_t *)snap;
+
+  for (uint8_t i = 0; i < sizeof(adxl345_snapshot_t); i++) {
+    regs[i] = adxl345_reg_info(ADXL345_REG_THRESH_TAP + i)->reset;
+  }
 }
 
-adxl345_err_t adxl345_get_time_ff_s(adxl345_t *adxl345, float *val) {
-  return get_converted_reg(adxl345, ADXL345_REG_TIME_FF, val,
-                           ADXL345_TIME_FF_SCALE);
+uint32_t adxl345_snapshot_config_mask(void) {
+  uint32_t mask = 0;
+
+  for (uint8_t i = 0; i < sizeof(adxl345_snapshot_t); i++) {
+    if (adxl345_reg_info(ADXL345_REG_THRESH_TAP + i)->flags &
+        ADXL345_ACCESS_W) {
+      mask |= 1UL << i;
+    }
+  }
+  return mask;
 }
 
-adxl345_err_t adxl345_set_time_ff_s(adxl345_t *adxl345, float val) {
-  return set_converted_reg(adxl345, ADXL345_REG_TIME_FF, val,
-                           ADXL345_TIME_FF_SCALE);
+adxl345_err_t adxl345_verify(adxl345_t *adxl345,
+                             const adxl345_snapshot_t *expected,
+                             uint32_t *mismatch) {
+  adxl345_snapshot_t snap;
+  uint32_t diff;
+  adxl345_err_t err;
+
+  err = adxl345_snapshot(adxl345, ADXL345_SNAPSHOT_CONFIG, &snap);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  diff = adxl345_snapshot_diff(&snap, expected) &
+         adxl345_snapshot_config_mask();
+  if (mismatch != NULL) *mismatch = diff;
+  return (diff == 0) ? ADXL345_ERR_NONE : ADXL345_ERR_VERIFY;
 }
 
-adxl345_err_t adxl345_available_samples(adxl345_t *adxl345, uint8_t *val) {
-  uint8_t reg;
-  adxl345_err_t err = adxl345_get_fifo_status_reg(adxl345, &reg);
-  *val = (err == ADXL345_ERR_NONE) ? reg & 0x1F : 0;
-  return err;
+// =============================================================================
+// local (static) code
+
+static int32_t round_clamp(float val, int32_t lo, int32_t hi) {
+  if (val <= lo) return lo;
+  if (val >= hi) return hi;
+  return (val < 0) ? (int32_t)(val - 0.5f) : (int32_t)(val + 0.5f);
 }
 
-/** @brief Read an x, y, z sample frame.
- */
-adxl345_err_t adxl345_get_isample(adxl345_t *adxl345,
-                                  adxl345_isample_t *sample) {
-  adxl345_data_regs_t regs;
+static adxl345_err_t self_test_run(adxl345_t *adxl345, uint16_t n_average,
+                                   adxl345_self_test_report_t *report) {
   adxl345_err_t err;
 
-  err = adxl345_get_data_regs(adxl345, &regs);
+  err = adxl345_write_reg(adxl345, ADXL345_REG_FIFO_CTL,
+                          ADXL345_FIFO_MODE_BYPASS, false);
+  if (err != ADXL345_ERR_NONE) return err;
+  err = adxl345_write_reg(adxl345, ADXL345_REG_FIFO_CTL,
+                          ADXL345_FIFO_MODE_STREAM, true);
   if (err != ADXL345_ERR_NONE) return err;
 
-  // Using default values:
-  //   x1:x0 is a 16 bit signed value with 10 bits of resolution.
-  sample->x = (int16_t)((regs.x1 << 8) | regs.x0);
-  sample->y = (int16_t)((regs.y1 << 8) | regs.y0);
-  sample->z = (int16_t)((regs.z1 << 8) | regs.z0);
+  err = self_test_average(adxl345, n_average, report->off);
+  if (err != ADXL345_ERR_NONE) return err;
 
-  return ADXL345_ERR_NONE;
+  err = adxl345_update_reg(adxl345, ADXL345_REG_DATA_FORMAT, ADXL345_SELF_TEST,
+                           ADXL345_SELF_TEST);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  // samples already in the FIFO were taken without the self-test force
+  err = adxl345_write_reg(adxl345, ADXL345_REG_FIFO_CTL,
+                          ADXL345_FIFO_MODE_BYPASS, false);
+  if (err != ADXL345_ERR_NONE) return err;
+  err = adxl345_write_reg(adxl345, ADXL345_REG_FIFO_CTL,
+                          ADXL345_FIFO_MODE_STREAM, true);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  return self_test_average(adxl345, n_average, report->on);
 }
 
-/** @brief Read an x, y, z sample frame.
- */
-adxl345_err_t adxl345_get_fsample(adxl345_t *adxl345,
-                                  adxl345_fsample_t *sample) {
-  adxl345_data_regs_t regs;
+static adxl345_err_t self_test_average(adxl345_t *adxl345,
+                                       uint16_t n_average, int16_t mean[3]) {
+  adxl345_isample_t batch[FIFO_DEPTH];
+  int32_t sum[3] = {0, 0, 0};
+  uint16_t settle = SELF_TEST_SETTLE;
+  uint16_t remaining = n_average;
+  uint16_t polls = 0;
   adxl345_err_t err;
 
-  err = adxl345_get_data_regs(adxl345, &regs);
-  if (err != ADXL345_ERR_NONE) return err;
+  while (remaining > 0) {
+    uint8_t entries;
 
-  // Using default values:
-  //   x1:x0 is a 16 bit signed value with 10 bits of resolution.
-  //   Full scale is 2^9 = 512 corresponding to 2g
-  //   This can change with sensitivity settings, packing mode, etc.
-  sample->x = (int16_t)((regs.x1 << 8) | regs.x0) * ADXL345_2G_SCALE;
-  sample->y = (int16_t)((regs.y1 << 8) | regs.y0) * ADXL345_2G_SCALE;
-  sample->z = (int16_t)((regs.z1 << 8) | regs.z0) * ADXL345_2G_SCALE;
+    err = adxl345_available_samples(adxl345, &entries);
+    if (err != ADXL345_ERR_NONE) return err;
+    if (entries == 0) {
+      if (++polls >= ADXL345_SELF_TEST_MAX_POLLS) return ADXL345_ERR_READ;
+      continue;
+    }
+    polls = 0;
+    // any excess is picked up on the next pass
+    if (entries > FIFO_DEPTH) entries = FIFO_DEPTH;
+
+    err = adxl345_get_isamples(adxl345, batch, entries);
+    if (err != ADXL345_ERR_NONE) return err;
 
+    for (uint8_t i = 0; (i < entries) && (remaining > 0); i++) {
+      if (settle > 0) {
+        settle -= 1;
+        continue;
+      }
+      sum[0] += batch[i].x;
+      sum[1] += batch[i].y;
+      sum[2] += batch[i].z;
+      remaining -= 1;
+    }
+  }
+
+  for (int axis = 0; axis < 3; axis++) {
+    int32_t half = (sum[axis] < 0) ? -(n_average / 2) : n_average / 2;
+    mean[axis] = (int16_t)((sum[axis] + half) / n_average);
+  }
   return ADXL345_ERR_NONE;
 }
 
-// =============================================================================
-// local (static) code
+// interpolate the datasheet supply table and scale a 2.5 V limit
+static int16_t self_test_scale(int16_t limit, const uint8_t *pct,
+                               uint16_t supply_mv) {
+  int i = 0;
+  int32_t scale;
 
-static adxl345_err_t get_converted_reg(adxl345_t *adxl345, uint8_t reg_id,
-                                       float *val, float scale) {
-  uint8_t reg;
-  adxl345_err_t err = adxl345_dev_read_reg(adxl345->dev, reg_id, &reg);
-  *val = (err == ADXL345_ERR_NONE) ? reg * scale : 0.0;
-  return err;
+  while ((i < SELF_TEST_SUPPLY_POINTS - 2) &&
+         (supply_mv > s_self_test_mv[i + 1])) {
+    i += 1;
+  }
+  // in hundredths of a percent
+  scale = pct[i] * 100 + (int32_t)(pct[i + 1] - pct[i]) * 100 *
+                             (supply_mv - s_self_test_mv[i]) /
+                             (s_self_test_mv[i + 1] - s_self_test_mv[i]);
+  return (int16_t)((int32_t)limit * scale / 10000);
 }
 
-static adxl345_err_t set_converted_reg(adxl345_t *adxl345, uint8_t reg_id,
-                                       float val, float scale) {
-  uint8_t reg = val / scale;
-  return adxl345_dev_write_reg(adxl345->dev, reg_id, reg);
+static void decode_isample(const adxl345_data_regs_t *regs,
+                           adxl345_isample_t *sample) {
+  // Using default values:
+  //   x1:x0 is a 16 bit signed value with 10 bits of resolution.
+  sample->x = (int16_t)((regs->x1 << 8) | regs->x0);
+  sample->y = (int16_t)((regs->y1 << 8) | regs->y0);
+  sample->z = (int16_t)((regs->z1 << 8) | regs->z0);
 }
@@ -112,12 +112,12 @@ typedef enum {
   ADXL345_INACT_AC_ENABLE = 0x08,  ///< Enable AC coupling for inactivity
                                    ///< detect.
   ADXL345_INACT_X_ENABLE = 0x04,   ///< Enable X axis for inactivity detection
-  ADXL345_INACT_Y_ENABLE = 0x01,   ///< Enable Y axis for inactivity detection
+  ADXL345_INACT_Y_ENABLE = 0x02,   ///< Enable Y axis for inactivity detection
   ADXL345_INACT_Z_ENABLE = 0x01,   ///< Enable Z axis for inactivity detection
 } adxl345_act_inact_ctl_reg;
 
 /** Map THRESH_FF register value to g */
-#define ADXL345_THRESH_FF_SCALE 0.00625
+#define ADXL345_THRESH_FF_SCALE 0.0625
 
 /** Map TIME_FF register value to seconds */
 #define ADXL345_TIME_FF_SCALE 0.005
@@ -223,6 +223,92 @@ typedef struct {
   adxl345_dev_t *dev;
 } adxl345_t;
 
+/**
+ * Registers 0x1D through 0x39, laid out as on the part so that a burst read
+ * lands directly in the struct.
+ */
+typedef struct {
+  uint8_t thresh_tap;          ///< 0x1D
+  int8_t ofsx;                 ///< 0x1E
+  int8_t ofsy;                 ///< 0x1F
+  int8_t ofsz;                 ///< 0x20
+  uint8_t dur;                 ///< 0x21
+  uint8_t latent;              ///< 0x22
+  uint8_t window;              ///< 0x23
+  uint8_t thresh_act;          ///< 0x24
+  uint8_t thresh_inact;        ///< 0x25
+  uint8_t time_inact;          ///< 0x26
+  uint8_t act_inact_ctl;       ///< 0x27
+  uint8_t thresh_ff;           ///< 0x28
+  uint8_t time_ff;             ///< 0x29
+  uint8_t tap_axes;            ///< 0x2A
+  uint8_t act_tap_status;      ///< 0x2B
+  uint8_t bw_rate;             ///< 0x2C
+  uint8_t power_ctl;           ///< 0x2D
+  uint8_t int_enable;          ///< 0x2E
+  uint8_t int_map;             ///< 0x2F
+  uint8_t int_source;          ///< 0x30
+  uint8_t data_format;         ///< 0x31
+  adxl345_data_regs_t data;    ///< 0x32..0x37, zero unless SNAPSHOT_ALL
+  uint8_t fifo_ctl;            ///< 0x38
+  uint8_t fifo_status;         ///< 0x39
+} adxl345_snapshot_t;
+
+typedef enum {
+  ADXL345_SNAPSHOT_ALL,     ///< one burst; pops a FIFO entry into data
+  ADXL345_SNAPSHOT_CONFIG,  ///< two bursts skipping the data registers
+} adxl345_snapshot_mode_t;
+
+/** Bit for a register in an adxl345_snapshot_diff() mask */
+#define ADXL345_SNAPSHOT_BIT(reg) (1UL << ((reg) - ADXL345_REG_THRESH_TAP))
+
+typedef enum {
+  ADXL345_ACCESS_R = 0x01,       ///< readable
+  ADXL345_ACCESS_W = 0x02,       ///< writable
+  ADXL345_ACCESS_RW = 0x03,      ///< readable and writable
+  ADXL345_ACCESS_SIGNED = 0x04,  ///< holds a two's complement value
+} adxl345_access_t;
+
+/**
+ * Describes one register.  A table of these, indexed by address, drives the
+ * generic accessors, adxl345_reset() and adxl345_verify().
+ */
+typedef struct {
+  uint8_t reg;    ///< register address
+  uint8_t flags;  ///< adxl345_access_t bits
+  uint8_t reset;  ///< power-on value
+  float scale;    ///< g or seconds per LSB, 0 for bit fields
+} adxl345_reg_info_t;
+
+/**
+ * Self-test limits at a 2.5 V supply, in full resolution LSBs (3.9 mg): the
+ * datasheet's 0.20 to 2.10 g for X, -2.10 to -0.20 g for Y and 0.30 to
+ * 3.40 g for Z.
+ */
+#define ADXL345_SELF_TEST_X_MIN 50
+#define ADXL345_SELF_TEST_X_MAX 540
+#define ADXL345_SELF_TEST_Y_MIN -540
+#define ADXL345_SELF_TEST_Y_MAX -50
+#define ADXL345_SELF_TEST_Z_MIN 75
+#define ADXL345_SELF_TEST_Z_MAX 875
+
+/** Supply range over which the self-test limits are specified, in mV */
+#define ADXL345_SELF_TEST_MIN_MV 2000
+#define ADXL345_SELF_TEST_MAX_MV 3600
+
+/** Consecutive empty FIFO polls before the self-test gives up */
+#define ADXL345_SELF_TEST_MAX_POLLS 10000
+
+typedef struct {
+  int16_t off[3];    ///< mean X, Y, Z with self-test off, 3.9 mg/LSB
+  int16_t on[3];     ///< mean X, Y, Z with self-test on, 3.9 mg/LSB
+  int16_t delta[3];  ///< on - off
+  int16_t min[3];    ///< lower limits after supply scaling
+  int16_t max[3];    ///< upper limits after supply scaling
+  uint8_t failed;    ///< bit 0 for X, 1 for Y, 2 for Z out of limits
+  bool pass;         ///< true if all three axes are within limits
+} adxl345_self_test_report_t;
+
 // =============================================================================
 // declarations
 
@@ -245,84 +331,311 @@ adxl345_err_t adxl345_reset(adxl345_t *adxl345);
 adxl345_err_t adxl345_write_reg(adxl345_t *adxl345, uint8_t reg_id, uint8_t val,
                                 bool verify);
 
+/**
+ * @brief Read a value from an ADXL345 register.
+ */
+adxl345_err_t adxl345_read_reg(adxl345_t *adxl345, uint8_t reg_id,
+                               uint8_t *val);
+
+/**
+ * @brief Read n consecutive registers in a single burst.
+ *
+ * Note that a burst covering DATAX0..DATAZ1 pops a FIFO entry and one
+ * covering INT_SOURCE clears the latched event bits.
+ */
+adxl345_err_t adxl345_read_regs(adxl345_t *adxl345, uint8_t reg_id,
+                                uint8_t *dst, uint8_t n);
+
+/**
+ * @brief Read-modify-write: replace the bits selected by mask with val.
+ */
+adxl345_err_t adxl345_update_reg(adxl345_t *adxl345, uint8_t reg_id,
+                                 uint8_t mask, uint8_t val);
+
 // ==========================================
-// low-level register access
+// low-level register access.  Every register goes through the descriptor
+// table, so reads of write-only addresses and writes to read-only ones are
+// refused with ADXL345_ERR_PARAM.
 
-adxl345_err_t adxl345_get_devid_reg(adxl345_t *adxl345, uint8_t *val);
+/**
+ * @brief Look up a register's descriptor.  Returns NULL for reserved
+ * addresses.
+ */
+const adxl345_reg_info_t *adxl345_reg_info(uint8_t reg_id);
 
-adxl345_err_t adxl345_get_thresh_tap_reg(adxl345_t *adxl345, uint8_t *val);
-adxl345_err_t adxl345_set_thresh_tap_reg(adxl345_t *adxl345, uint8_t val);
+/**
+ * @brief Read a register after checking that it is readable.
+ */
+adxl345_err_t adxl345_get_reg(adxl345_t *adxl345, uint8_t reg_id,
+                              uint8_t *val);
 
-adxl345_err_t adxl345_get_ofsx_reg(adxl345_t *adxl345, uint8_t *val);
-adxl345_err_t adxl345_set_ofsx_reg(adxl345_t *adxl345, uint8_t val);
+/**
+ * @brief Write a register after checking that it is writable.
+ */
+adxl345_err_t adxl345_set_reg(adxl345_t *adxl345, uint8_t reg_id, uint8_t val);
 
-adxl345_err_t adxl345_get_ofsy_reg(adxl345_t *adxl345, uint8_t *val);
-adxl345_err_t adxl345_set_ofsy_reg(adxl345_t *adxl345, uint8_t val);
+/**
+ * @brief Read a register and convert it to g or seconds using its scale and
+ * signedness.
+ */
+adxl345_err_t adxl345_get_scaled(adxl345_t *adxl345, uint8_t reg_id,
+                                 float *val);
 
-adxl345_err_t adxl345_get_ofsz_reg(adxl345_t *adxl345, uint8_t *val);
-adxl345_err_t adxl345_set_ofsz_reg(adxl345_t *adxl345, uint8_t val);
+/**
+ * @brief Convert g or seconds to the nearest register value, clamped to the
+ * register's range, and write it.
+ */
+adxl345_err_t adxl345_set_scaled(adxl345_t *adxl345, uint8_t reg_id,
+                                 float val);
 
-adxl345_err_t adxl345_get_dur_reg(adxl345_t *adxl345, uint8_t *val);
-adxl345_err_t adxl345_set_dur_reg(adxl345_t *adxl345, uint8_t val);
+/**
+ * @brief Fill a snapshot with the documented power-on values.
+ */
+void adxl345_snapshot_reset(adxl345_snapshot_t *snap);
 
-adxl345_err_t adxl345_get_latency_reg(adxl345_t *adxl345, uint8_t *val);
-adxl345_err_t adxl345_set_latency_reg(adxl345_t *adxl345, uint8_t val);
+/**
+ * @brief Mask of the writable registers, for adxl345_snapshot_diff().
+ */
+uint32_t adxl345_snapshot_config_mask(void);
 
-adxl345_err_t adxl345_get_window_reg(adxl345_t *adxl345, uint8_t *val);
-adxl345_err_t adxl345_set_window_reg(adxl345_t *adxl345, uint8_t val);
+/**
+ * @brief Check the device's configuration registers against a snapshot.
+ *
+ * Reads an ADXL345_SNAPSHOT_CONFIG snapshot and compares the writable
+ * registers.  *mismatch (may be NULL) receives the differing registers as
+ * an adxl345_snapshot_diff() mask; returns ADXL345_ERR_VERIFY if any
+ * differ.
+ */
+adxl345_err_t adxl345_verify(adxl345_t *adxl345,
+                             const adxl345_snapshot_t *expected,
+                             uint32_t *mismatch);
 
-adxl345_err_t adxl345_get_thresh_act_reg(adxl345_t *adxl345, uint8_t *val);
-adxl345_err_t adxl345_set_thresh_act_reg(adxl345_t *adxl345, uint8_t val);
+static inline adxl345_err_t adxl345_get_devid_reg(adxl345_t *adxl345,
+                                                  uint8_t *val) {
+  return adxl345_get_reg(adxl345, ADXL345_REG_DEVID, val);
+}
 
-adxl345_err_t adxl345_get_thresh_inact_reg(adxl345_t *adxl345, uint8_t *val);
-adxl345_err_t adxl345_set_thresh_inact_reg(adxl345_t *adxl345, uint8_t val);
+static inline adxl345_err_t adxl345_get_thresh_tap_reg(adxl345_t *adxl345,
+                                                       uint8_t *val) {
+  return adxl345_get_reg(adxl345, ADXL345_REG_THRESH_TAP, val);
+}
+static inline adxl345_err_t adxl345_set_thresh_tap_reg(adxl345_t *adxl345,
+                                                       uint8_t val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_THRESH_TAP, val);
+}
 
-adxl345_err_t adxl345_get_time_inact_reg(adxl345_t *adxl345, uint8_t *val);
-adxl345_err_t adxl345_set_time_inact_reg(adxl345_t *adxl345, uint8_t val);
+static inline adxl345_err_t adxl345_get_ofsx_reg(adxl345_t *adxl345,
+                                                 uint8_t *val) {
+  return adxl345_get_reg(adxl345, ADXL345_REG_OFSX, val);
+}
+static inline adxl345_err_t adxl345_set_ofsx_reg(adxl345_t *adxl345,
+                                                 uint8_t val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_OFSX, val);
+}
 
-adxl345_err_t adxl345_get_act_inact_ctl_reg(adxl345_t *adxl345,
-                                            adxl345_act_inact_ctl_reg *val);
-adxl345_err_t adxl345_set_act_inact_ctl_reg(adxl345_t *adxl345,
-                                            adxl345_act_inact_ctl_reg val);
+static inline adxl345_err_t adxl345_get_ofsy_reg(adxl345_t *adxl345,
+                                                 uint8_t *val) {
+  return adxl345_get_reg(adxl345, ADXL345_REG_OFSY, val);
+}
+static inline adxl345_err_t adxl345_set_ofsy_reg(adxl345_t *adxl345,
+                                                 uint8_t val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_OFSY, val);
+}
 
-adxl345_err_t adxl345_get_thresh_ff_reg(adxl345_t *adxl345, uint8_t *val);
-adxl345_err_t adxl345_set_thresh_ff_reg(adxl345_t *adxl345, uint8_t val);
+static inline adxl345_err_t adxl345_get_ofsz_reg(adxl345_t *adxl345,
+                                                 uint8_t *val) {
+  return adxl345_get_reg(adxl345, ADXL345_REG_OFSZ, val);
+}
+static inline adxl345_err_t adxl345_set_ofsz_reg(adxl345_t *adxl345,
+                                                 uint8_t val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_OFSZ, val);
+}
 
-adxl345_err_t adxl345_get_time_ff_reg(adxl345_t *adxl345, uint8_t *val);
-adxl345_err_t adxl345_set_time_ff_reg(adxl345_t *adxl345, uint8_t val);
+static inline adxl345_err_t adxl345_get_dur_reg(adxl345_t *adxl345,
+                                                uint8_t *val) {
+  return adxl345_get_reg(adxl345, ADXL345_REG_DUR, val);
+}
+static inline adxl345_err_t adxl345_set_dur_reg(adxl345_t *adxl345,
+                                                uint8_t val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_DUR, val);
+}
 
-adxl345_err_t adxl345_get_tap_axes_reg(adxl345_t *adxl345,
-                                       adxl345_tap_axes_reg *val);
-adxl345_err_t adxl345_set_tap_axes_reg(adxl345_t *adxl345,
-                                       adxl345_tap_axes_reg val);
+static inline adxl345_err_t adxl345_get_latency_reg(adxl345_t *adxl345,
+                                                    uint8_t *val) {
+  return adxl345_get_reg(adxl345, ADXL345_REG_LATENT, val);
+}
+static inline adxl345_err_t adxl345_set_latency_reg(adxl345_t *adxl345,
+                                                    uint8_t val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_LATENT, val);
+}
 
-adxl345_err_t adxl345_get_bw_rate_reg(adxl345_t *adxl345,
-                                      adxl345_bw_rate_reg *val);
-adxl345_err_t adxl345_set_bw_rate_reg(adxl345_t *adxl345,
-                                      adxl345_bw_rate_reg val);
+static inline adxl345_err_t adxl345_get_window_reg(adxl345_t *adxl345,
+                                                   uint8_t *val) {
+  return adxl345_get_reg(adxl345, ADXL345_REG_WINDOW, val);
+}
+static inline adxl345_err_t adxl345_set_window_reg(adxl345_t *adxl345,
+                                                   uint8_t val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_WINDOW, val);
+}
 
-adxl345_err_t adxl345_get_power_ctl_reg(adxl345_t *adxl345,
-                                        adxl345_power_ctl_reg *val);
-adxl345_err_t adxl345_set_power_ctl_reg(adxl345_t *adxl345,
-                                        adxl345_power_ctl_reg val);
+static inline adxl345_err_t adxl345_get_thresh_act_reg(adxl345_t *adxl345,
+                                                       uint8_t *val) {
+  return adxl345_get_reg(adxl345, ADXL345_REG_THRESH_ACT, val);
+}
+static inline adxl345_err_t adxl345_set_thresh_act_reg(adxl345_t *adxl345,
+                                                       uint8_t val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_THRESH_ACT, val);
+}
 
-adxl345_err_t adxl345_get_int_enable_reg(adxl345_t *adxl345,
-                                         adxl345_interrupt_reg *val);
-adxl345_err_t adxl345_set_int_enable_reg(adxl345_t *adxl345,
-                                         adxl345_interrupt_reg val);
+static inline adxl345_err_t adxl345_get_thresh_inact_reg(adxl345_t *adxl345,
+                                                         uint8_t *val) {
+  return adxl345_get_reg(adxl345, ADXL345_REG_THRESH_INACT, val);
+}
+static inline adxl345_err_t adxl345_set_thresh_inact_reg(adxl345_t *adxl345,
+                                                         uint8_t val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_THRESH_INACT, val);
+}
 
-adxl345_err_t adxl345_get_int_map_reg(adxl345_t *adxl345,
-                                      adxl345_interrupt_reg *val);
-adxl345_err_t adxl345_set_int_map_reg(adxl345_t *adxl345,
-                                      adxl345_interrupt_reg val);
+static inline adxl345_err_t adxl345_get_time_inact_reg(adxl345_t *adxl345,
+                                                       uint8_t *val) {
+  return adxl345_get_reg(adxl345, ADXL345_REG_TIME_INACT, val);
+}
+static inline adxl345_err_t adxl345_set_time_inact_reg(adxl345_t *adxl345,
+                                                       uint8_t val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_TIME_INACT, val);
+}
 
-adxl345_err_t adxl345_get_int_source_reg(adxl345_t *adxl345,
-                                         adxl345_interrupt_reg *val);
+static inline adxl345_err_t
+adxl345_get_act_inact_ctl_reg(adxl345_t *adxl345,
+                              adxl345_act_inact_ctl_reg *val) {
+  uint8_t reg;
+  adxl345_err_t err = adxl345_get_reg(adxl345, ADXL345_REG_ACT_INACT_CTL, &reg);
+  if (err == ADXL345_ERR_NONE) *val = (adxl345_act_inact_ctl_reg)reg;
+  return err;
+}
+static inline adxl345_err_t
+adxl345_set_act_inact_ctl_reg(adxl345_t *adxl345,
+                              adxl345_act_inact_ctl_reg val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_ACT_INACT_CTL, val);
+}
 
-adxl345_err_t adxl345_get_data_format_reg(adxl345_t *adxl345,
-                                          adxl345_data_format_reg *val);
-adxl345_err_t adxl345_set_data_format_reg(adxl345_t *adxl345,
-                                          adxl345_data_format_reg val);
+static inline adxl345_err_t adxl345_get_thresh_ff_reg(adxl345_t *adxl345,
+                                                      uint8_t *val) {
+  return adxl345_get_reg(adxl345, ADXL345_REG_THRESH_FF, val);
+}
+static inline adxl345_err_t adxl345_set_thresh_ff_reg(adxl345_t *adxl345,
+                                                      uint8_t val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_THRESH_FF, val);
+}
+
+static inline adxl345_err_t adxl345_get_time_ff_reg(adxl345_t *adxl345,
+                                                    uint8_t *val) {
+  return adxl345_get_reg(adxl345, ADXL345_REG_TIME_FF, val);
+}
+static inline adxl345_err_t adxl345_set_time_ff_reg(adxl345_t *adxl345,
+                                                    uint8_t val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_TIME_FF, val);
+}
+
+static inline adxl345_err_t
+adxl345_get_tap_axes_reg(adxl345_t *adxl345, adxl345_tap_axes_reg *val) {
+  uint8_t reg;
+  adxl345_err_t err = adxl345_get_reg(adxl345, ADXL345_REG_TAP_AXES, &reg);
+  if (err == ADXL345_ERR_NONE) *val = (adxl345_tap_axes_reg)reg;
+  return err;
+}
+static inline adxl345_err_t adxl345_set_tap_axes_reg(adxl345_t *adxl345,
+                                                     adxl345_tap_axes_reg val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_TAP_AXES, val);
+}
+
+static inline adxl345_err_t adxl345_get_bw_rate_reg(adxl345_t *adxl345,
+                                                    adxl345_bw_rate_reg *val) {
+  uint8_t reg;
+  adxl345_err_t err = adxl345_get_reg(adxl345, ADXL345_REG_BW_RATE, &reg);
+  if (err == ADXL345_ERR_NONE) *val = (adxl345_bw_rate_reg)reg;
+  return err;
+}
+static inline adxl345_err_t adxl345_set_bw_rate_reg(adxl345_t *adxl345,
+                                                    adxl345_bw_rate_reg val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_BW_RATE, val);
+}
+
+static inline adxl345_err_t
+adxl345_get_power_ctl_reg(adxl345_t *adxl345, adxl345_power_ctl_reg *val) {
+  uint8_t reg;
+  adxl345_err_t err = adxl345_get_reg(adxl345, ADXL345_REG_POWER_CTL, &reg);
+  if (err == ADXL345_ERR_NONE) *val = (adxl345_power_ctl_reg)reg;
+  return err;
+}
+static inline adxl345_err_t
+adxl345_set_power_ctl_reg(adxl345_t *adxl345, adxl345_power_ctl_reg val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_POWER_CTL, val);
+}
+
+static inline adxl345_err_t
+adxl345_get_int_enable_reg(adxl345_t *adxl345, adxl345_interrupt_reg *val) {
+  uint8_t reg;
+  adxl345_err_t err = adxl345_get_reg(adxl345, ADXL345_REG_INT_ENABLE, &reg);
+  if (err == ADXL345_ERR_NONE) *val = (adxl345_interrupt_reg)reg;
+  return err;
+}
+static inline adxl345_err_t
+adxl345_set_int_enable_reg(adxl345_t *adxl345, adxl345_interrupt_reg val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_INT_ENABLE, val);
+}
+
+static inline adxl345_err_t
+adxl345_get_int_map_reg(adxl345_t *adxl345, adxl345_interrupt_reg *val) {
+  uint8_t reg;
+  adxl345_err_t err = adxl345_get_reg(adxl345, ADXL345_REG_INT_MAP, &reg);
+  if (err == ADXL345_ERR_NONE) *val = (adxl345_interrupt_reg)reg;
+  return err;
+}
+static inline adxl345_err_t adxl345_set_int_map_reg(adxl345_t *adxl345,
+                                                    adxl345_interrupt_reg val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_INT_MAP, val);
+}
+
+static inline adxl345_err_t
+adxl345_get_int_source_reg(adxl345_t *adxl345, adxl345_interrupt_reg *val) {
+  uint8_t reg;
+  adxl345_err_t err = adxl345_get_reg(adxl345, ADXL345_REG_INT_SOURCE, &reg);
+  if (err == ADXL345_ERR_NONE) *val = (adxl345_interrupt_reg)reg;
+  return err;
+}
+
+static inline adxl345_err_t
+adxl345_get_data_format_reg(adxl345_t *adxl345, adxl345_data_format_reg *val) {
+  uint8_t reg;
+  adxl345_err_t err = adxl345_get_reg(adxl345, ADXL345_REG_DATA_FORMAT, &reg);
+  if (err == ADXL345_ERR_NONE) *val = (adxl345_data_format_reg)reg;
+  return err;
+}
+static inline adxl345_err_t
+adxl345_set_data_format_reg(adxl345_t *adxl345, adxl345_data_format_reg val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_DATA_FORMAT, val);
+}
+
+static inline adxl345_err_t
+adxl345_get_fifo_ctl_reg(adxl345_t *adxl345, adxl345_fifo_mode_reg *val) {
+  uint8_t reg;
+  adxl345_err_t err = adxl345_get_reg(adxl345, ADXL345_REG_FIFO_CTL, &reg);
+  if (err == ADXL345_ERR_NONE) *val = (adxl345_fifo_mode_reg)reg;
+  return err;
+}
+static inline adxl345_err_t
+adxl345_set_fifo_ctl_reg(adxl345_t *adxl345, adxl345_fifo_mode_reg val) {
+  return adxl345_set_reg(adxl345, ADXL345_REG_FIFO_CTL, val);
+}
+
+static inline adxl345_err_t
+adxl345_get_fifo_status_reg(adxl345_t *adxl345, adxl345_fifo_status_reg *val) {
+  uint8_t reg;
+  adxl345_err_t err = adxl345_get_reg(adxl345, ADXL345_REG_FIFO_STATUS, &reg);
+  if (err == ADXL345_ERR_NONE) *val = (adxl345_fifo_status_reg)reg;
+  return err;
+}
 
 // Because x, y, z samples must be read in a single operation,
 // these methods are not provided.
@@ -339,14 +652,6 @@ adxl345_err_t adxl345_set_data_format_reg(adxl345_t *adxl345,
 adxl345_err_t adxl345_get_data_regs(adxl345_t *adxl345,
                                     adxl345_data_regs_t *dst);
 
-adxl345_err_t adxl345_get_fifo_ctl_reg(adxl345_t *adxl345,
-                                       adxl345_fifo_mode_reg *val);
-adxl345_err_t adxl345_set_fifo_ctl_reg(adxl345_t *adxl345,
-                                       adxl345_fifo_mode_reg val);
-
-adxl345_err_t adxl345_get_fifo_status_reg(adxl345_t *adxl345,
-                                          adxl345_fifo_status_reg *val);
-
 // ==========================================
 // higher level functions.  In the functions below,
 // _g stands for gravity and _s stands for seconds.
@@ -367,52 +672,195 @@ adxl345_err_t adxl345_stop(adxl345_t *adxl345);
 adxl345_err_t adxl345_is_sample_available(adxl345_t *adxl345,
                                           bool *is_sample_available);
 
-adxl345_err_t adxl345_get_tap_thresh_g(adxl345_t *adxl345, float *val);
-adxl345_err_t adxl345_set_tap_thresh_g(adxl345_t *adxl345, float val);
+static inline adxl345_err_t adxl345_get_tap_thresh_g(adxl345_t *adxl345,
+                                                     float *val) {
+  return adxl345_get_scaled(adxl345, ADXL345_REG_THRESH_TAP, val);
+}
+static inline adxl345_err_t adxl345_set_tap_thresh_g(adxl345_t *adxl345,
+                                                     float val) {
+  return adxl345_set_scaled(adxl345, ADXL345_REG_THRESH_TAP, val);
+}
+
+static inline adxl345_err_t adxl345_get_ofsx_g(adxl345_t *adxl345, float *val) {
+  return adxl345_get_scaled(adxl345, ADXL345_REG_OFSX, val);
+}
+static inline adxl345_err_t adxl345_set_ofsx_g(adxl345_t *adxl345, float val) {
+  return adxl345_set_scaled(adxl345, ADXL345_REG_OFSX, val);
+}
 
-adxl345_err_t adxl345_get_ofsx_g(adxl345_t *adxl345, float *val);
-adxl345_err_t adxl345_set_ofsx_g(adxl345_t *adxl345, float val);
+static inline adxl345_err_t adxl345_get_ofsy_g(adxl345_t *adxl345, float *val) {
+  return adxl345_get_scaled(adxl345, ADXL345_REG_OFSY, val);
+}
+static inline adxl345_err_t adxl345_set_ofsy_g(adxl345_t *adxl345, float val) {
+  return adxl345_set_scaled(adxl345, ADXL345_REG_OFSY, val);
+}
+
+static inline adxl345_err_t adxl345_get_ofsz_g(adxl345_t *adxl345, float *val) {
+  return adxl345_get_scaled(adxl345, ADXL345_REG_OFSZ, val);
+}
+static inline adxl345_err_t adxl345_set_ofsz_g(adxl345_t *adxl345, float val) {
+  return adxl345_set_scaled(adxl345, ADXL345_REG_OFSZ, val);
+}
+
+static inline adxl345_err_t adxl345_get_dur_g(adxl345_t *adxl345, float *val) {
+  return adxl345_get_scaled(adxl345, ADXL345_REG_DUR, val);
+}
+static inline adxl345_err_t adxl345_set_dur_g(adxl345_t *adxl345, float val) {
+  return adxl345_set_scaled(adxl345, ADXL345_REG_DUR, val);
+}
+
+static inline adxl345_err_t adxl345_get_latency_s(adxl345_t *adxl345,
+                                                  float *val) {
+  return adxl345_get_scaled(adxl345, ADXL345_REG_LATENT, val);
+}
+static inline adxl345_err_t adxl345_set_latency_s(adxl345_t *adxl345,
+                                                  float val) {
+  return adxl345_set_scaled(adxl345, ADXL345_REG_LATENT, val);
+}
 
-adxl345_err_t adxl345_get_ofsy_g(adxl345_t *adxl345, float *val);
-adxl345_err_t adxl345_set_ofsy_g(adxl345_t *adxl345, float val);
+static inline adxl345_err_t adxl345_get_window_s(adxl345_t *adxl345,
+                                                 float *val) {
+  return adxl345_get_scaled(adxl345, ADXL345_REG_WINDOW, val);
+}
+static inline adxl345_err_t adxl345_set_window_s(adxl345_t *adxl345,
+                                                 float val) {
+  return adxl345_set_scaled(adxl345, ADXL345_REG_WINDOW, val);
+}
 
-adxl345_err_t adxl345_get_ofsz_g(adxl345_t *adxl345, float *val);
-adxl345_err_t adxl345_set_ofsz_g(adxl345_t *adxl345, float val);
+static inline adxl345_err_t adxl345_get_thresh_act_g(adxl345_t *adxl345,
+                                                     float *val) {
+  return adxl345_get_scaled(adxl345, ADXL345_REG_THRESH_ACT, val);
+}
+static inline adxl345_err_t adxl345_set_thresh_act_g(adxl345_t *adxl345,
+                                                     float val) {
+  return adxl345_set_scaled(adxl345, ADXL345_REG_THRESH_ACT, val);
+}
 
-adxl345_err_t adxl345_get_dur_g(adxl345_t *adxl345, float *val);
-adxl345_err_t adxl345_set_dur_g(adxl345_t *adxl345, float val);
+static inline adxl345_err_t adxl345_get_thresh_inact_g(adxl345_t *adxl345,
+                                                       float *val) {
+  return adxl345_get_scaled(adxl345, ADXL345_REG_THRESH_INACT, val);
+}
+static inline adxl345_err_t adxl345_set_thresh_inact_g(adxl345_t *adxl345,
+                                                       float val) {
+  return adxl345_set_scaled(adxl345, ADXL345_REG_THRESH_INACT, val);
+}
 
-adxl345_err_t adxl345_get_latency_s(adxl345_t *adxl345, float *val);
-adxl345_err_t adxl345_set_latency_s(adxl345_t *adxl345, float val);
+static inline adxl345_err_t adxl345_get_time_inact_s(adxl345_t *adxl345,
+                                                     float *val) {
+  return adxl345_get_scaled(adxl345, ADXL345_REG_TIME_INACT, val);
+}
+static inline adxl345_err_t adxl345_set_time_inact_s(adxl345_t *adxl345,
+                                                     float val) {
+  return adxl345_set_scaled(adxl345, ADXL345_REG_TIME_INACT, val);
+}
 
-adxl345_err_t adxl345_get_window_s(adxl345_t *adxl345, float *val);
-adxl345_err_t adxl345_set_window_s(adxl345_t *adxl345, float val);
+static inline adxl345_err_t adxl345_get_thresh_ff_g(adxl345_t *adxl345,
+                                                    float *val) {
+  return adxl345_get_scaled(adxl345, ADXL345_REG_THRESH_FF, val);
+}
+static inline adxl345_err_t adxl345_set_thresh_ff_g(adxl345_t *adxl345,
+                                                    float val) {
+  return adxl345_set_scaled(adxl345, ADXL345_REG_THRESH_FF, val);
+}
 
-adxl345_err_t adxl345_get_thresh_act_g(adxl345_t *adxl345, float *val);
-adxl345_err_t adxl345_set_thresh_act_g(adxl345_t *adxl345, float val);
+static inline adxl345_err_t adxl345_get_time_ff_s(adxl345_t *adxl345,
+                                                  float *val) {
+  return adxl345_get_scaled(adxl345, ADXL345_REG_TIME_FF, val);
+}
+static inline adxl345_err_t adxl345_set_time_ff_s(adxl345_t *adxl345,
+                                                  float val) {
+  return adxl345_set_scaled(adxl345, ADXL345_REG_TIME_FF, val);
+}
 
-adxl345_err_t adxl345_get_thresh_inact_g(adxl345_t *adxl345, float *val);
-adxl345_err_t adxl345_set_thresh_inact_g(adxl345_t *adxl345, float val);
+/**
+ * @brief Largest positive raw sample code for a DATA_FORMAT setting.
+ *
+ * 10-bit mode always spans +/-511; full resolution mode adds one bit per
+ * range step (+/-511 at 2g up to +/-4095 at 16g).
+ */
+int16_t adxl345_format_full_scale(uint8_t data_format);
 
-adxl345_err_t adxl345_get_time_inact_s(adxl345_t *adxl345, float *val);
-adxl345_err_t adxl345_set_time_inact_s(adxl345_t *adxl345, float val);
+/**
+ * @brief Left shift that converts raw codes to 1/256 g (full resolution) units.
+ *
+ * Zero in full resolution mode, where every range is nominally 3.9 mg/LSB;
+ * the range bits in 10-bit mode.  Left-justified data is not handled.
+ */
+uint8_t adxl345_format_shift(uint8_t data_format);
 
-adxl345_err_t adxl345_get_thresh_ff_g(adxl345_t *adxl345, float *val);
-adxl345_err_t adxl345_set_thresh_ff_g(adxl345_t *adxl345, float val);
+/**
+ * @brief Convert a BW_RATE rate code to an output data rate in millihertz.
+ *
+ * The LOW_POWER bit is ignored.  3200 Hz halves with each step down, so the
+ * slowest codes round down slightly (0x00 gives 97 mHz).
+ */
+uint32_t adxl345_rate_to_mhz(uint8_t bw_rate);
 
-adxl345_err_t adxl345_get_time_ff_s(adxl345_t *adxl345, float *val);
-adxl345_err_t adxl345_set_time_ff_s(adxl345_t *adxl345, float val);
+/**
+ * @brief Read BW_RATE and return the output data rate in millihertz.
+ */
+adxl345_err_t adxl345_get_rate_mhz(adxl345_t *adxl345, uint32_t *mhz);
 
 adxl345_err_t adxl345_available_samples(adxl345_t *adxl345, uint8_t *val);
 
 adxl345_err_t adxl345_get_isample(adxl345_t *adxl345,
                                   adxl345_isample_t *sample);
 
+/** @brief Read n x, y, z sample frames from the FIFO.
+ *
+ * Each FIFO entry is popped with its own six-byte burst, so the caller should
+ * not ask for more than adxl345_available_samples() reports.
+ */
+adxl345_err_t adxl345_get_isamples(adxl345_t *adxl345,
+                                   adxl345_isample_t *samples, uint8_t n);
+
 /** @brief Read an x, y, z sample frame.
  */
 adxl345_err_t adxl345_get_fsample(adxl345_t *adxl345,
                                   adxl345_fsample_t *sample);
 
+/**
+ * @brief Run the datasheet self-test and check the result against limits.
+ *
+ * Following the datasheet procedure, the part is switched to full resolution
+ * +/-16 g at 800 Hz so the self-test force cannot clip whatever the caller's
+ * range.  n_average samples are averaged from FIFO batches with SELF_TEST
+ * off and then on, after discarding the samples taken while settling.  The
+ * limits are scaled for supply_mv (2000 to 3600 mV) from the datasheet's
+ * supply table.  BW_RATE, DATA_FORMAT, POWER_CTL and FIFO_CTL are restored
+ * afterwards and the FIFO is flushed.
+ *
+ * With n_average = 32 the test takes about 100 ms.  Returns
+ * ADXL345_ERR_PARAM for a bad argument and ADXL345_ERR_READ if the FIFO
+ * stops filling.  A failed test is reported in report->pass, not as an
+ * error.
+ */
+adxl345_err_t adxl345_self_test(adxl345_t *adxl345, uint16_t supply_mv,
+                                uint16_t n_average,
+                                adxl345_self_test_report_t *report);
+
+/**
+ * @brief Read registers 0x1D through 0x39 into a snapshot.
+ *
+ * ADXL345_SNAPSHOT_ALL uses a single burst, which pops one FIFO entry into
+ * snap->data.  ADXL345_SNAPSHOT_CONFIG reads 0x1D..0x31 and 0x38..0x39 as
+ * two bursts, leaving the FIFO alone and snap->data zeroed.  Either way
+ * INT_SOURCE is read, which clears its latched event bits.
+ */
+adxl345_err_t adxl345_snapshot(adxl345_t *adxl345,
+                               adxl345_snapshot_mode_t mode,
+                               adxl345_snapshot_t *snap);
+
+/**
+ * @brief Compare two snapshots.
+ *
+ * Returns a mask with ADXL345_SNAPSHOT_BIT(reg) set for every register that
+ * differs.  AND it with adxl345_snapshot_config_mask() to check
+ * configuration only.
+ */
+uint32_t adxl345_snapshot_diff(const adxl345_snapshot_t *a,
+                               const adxl345_snapshot_t *b);
+
 #ifdef __cplusplus
 }
 #endif
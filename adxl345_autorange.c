@@ -0,0 +1,226 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include "adxl345_autorange.h"
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// local types and definitions
+
+#define RANGE_MASK ADXL345_RANGE_16G
+
+// full scale of a range, in 1/256 g
+#define RANGE_LIMIT(range) (512 << (range))
+
+// =============================================================================
+// local (forward) declarations
+
+static int16_t abs16(int16_t v);
+
+static void rescale(adxl345_isample_t *samples, uint16_t n, uint8_t shift,
+                    int16_t full_scale, adxl345_autorange_info_t *info);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+adxl345_err_t adxl345_autorange_init(adxl345_autorange_t *ar,
+                                     adxl345_t *adxl345, uint8_t min_range,
+                                     uint8_t max_range, uint16_t hold_batches) {
+  adxl345_err_t err;
+
+  if ((min_range > max_range) || (max_range > ADXL345_RANGE_16G)) {
+    return ADXL345_ERR_PARAM;
+  }
+
+  ar->adxl345 = adxl345;
+  ar->min_range = min_range;
+  ar->max_range = max_range;
+  ar->up_pct = 90;
+  ar->down_pct = 40;
+  ar->hold_batches = hold_batches;
+  ar->quiet = 0;
+  ar->switches = 0;
+  ar->stale = 0;
+  ar->stale_format = 0;
+
+  err = adxl345_read_reg(adxl345, ADXL345_REG_DATA_FORMAT, &ar->data_format);
+  if (err != ADXL345_ERR_NONE) return err;
+  if (ar->data_format & ADXL345_LEFT_JUSTIFY) return ADXL345_ERR_PARAM;
+
+  // start inside the allowed span
+  if ((ar->data_format & RANGE_MASK) < min_range) {
+    return adxl345_autorange_apply(ar, min_range);
+  } else if ((ar->data_format & RANGE_MASK) > max_range) {
+    return adxl345_autorange_apply(ar, max_range);
+  }
+  return ADXL345_ERR_NONE;
+}
+
+uint8_t adxl345_autorange_process(adxl345_autorange_t *ar,
+                                  adxl345_isample_t *samples, uint16_t n,
+                                  adxl345_autorange_info_t *info) {
+  uint8_t range = ar->data_format & RANGE_MASK;
+  int32_t peak;
+
+  rescale(samples, n, adxl345_format_shift(ar->data_format),
+          adxl345_format_full_scale(ar->data_format), info);
+  info->range = range;
+  info->switched = false;
+  peak = info->peak;
+
+  if (info->saturated ||
+      (peak * 100 >= (int32_t)RANGE_LIMIT(range) * ar->up_pct)) {
+    ar->quiet = 0;
+    return (range < ar->max_range) ? range + 1 : range;
+  }
+
+  if ((range > ar->min_range) &&
+      (peak * 100 < (int32_t)RANGE_LIMIT(range - 1) * ar->down_pct)) {
+    if (++ar->quiet >= ar->hold_batches) {
+      ar->quiet = 0;
+      return range - 1;
+    }
+  } else {
+    ar->quiet = 0;
+  }
+  return range;
+}
+
+adxl345_err_t adxl345_autorange_apply(adxl345_autorange_t *ar, uint8_t range) {
+  uint8_t data_format = (ar->data_format & ~RANGE_MASK) | (range & RANGE_MASK);
+  adxl345_err_t err;
+
+  if (data_format == ar->data_format) return ADXL345_ERR_NONE;
+
+  err = adxl345_write_reg(ar->adxl345, ADXL345_REG_DATA_FORMAT, data_format,
+                          false);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  ar->data_format = data_format;
+  ar->switches += 1;
+  return ADXL345_ERR_NONE;
+}
+
+adxl345_err_t adxl345_autorange_service(adxl345_autorange_t *ar,
+                                        adxl345_isample_t *dst,
+                                        uint8_t capacity, uint8_t *n_read,
+                                        adxl345_autorange_info_t *info) {
+  uint8_t old_format = ar->data_format;
+  uint8_t entries;
+  uint8_t n_stale;
+  uint8_t range;
+  adxl345_autorange_info_t late;
+  adxl345_err_t err;
+
+  *n_read = 0;
+  err = adxl345_available_samples(ar->adxl345, &entries);
+  if (err != ADXL345_ERR_NONE) return err;
+  if (entries > capacity) entries = capacity;
+
+  err = adxl345_get_isamples(ar->adxl345, dst, entries);
+  if (err != ADXL345_ERR_NONE) return err;
+  *n_read = entries;
+
+  // entries queued before the last switch come out first
+  n_stale = (ar->stale < entries) ? ar->stale : entries;
+  rescale(dst, n_stale, adxl345_format_shift(ar->stale_format),
+          adxl345_format_full_scale(ar->stale_format), &late);
+  ar->stale -= n_stale;
+  if (n_stale == entries) {
+    // nothing at the current range yet, so nothing to decide on
+    info->range = ar->stale_format & RANGE_MASK;
+    info->peak = late.peak;
+    info->saturated = late.saturated;
+    info->switched = false;
+    return ADXL345_ERR_NONE;
+  }
+
+  range = adxl345_autorange_process(ar, &dst[n_stale], entries - n_stale,
+                                    info);
+  if (late.peak > info->peak) info->peak = late.peak;
+  info->saturated |= late.saturated;
+  // a second switch would mix two old ranges in the queue
+  if ((range == (old_format & RANGE_MASK)) || (ar->stale > 0)) {
+    return ADXL345_ERR_NONE;
+  }
+
+  err = adxl345_autorange_apply(ar, range);
+  if (err != ADXL345_ERR_NONE) return err;
+  info->switched = true;
+
+  // everything queued now, including what arrived while deciding, was taken
+  // at the old range; deliver what fits and remember the rest
+  err = adxl345_available_samples(ar->adxl345, &ar->stale);
+  if (err != ADXL345_ERR_NONE) return err;
+  ar->stale_format = old_format;
+  entries = ar->stale;
+  if (entries > capacity - *n_read) entries = capacity - *n_read;
+
+  err = adxl345_get_isamples(ar->adxl345, &dst[*n_read], entries);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  rescale(&dst[*n_read], entries, adxl345_format_shift(old_format),
+          adxl345_format_full_scale(old_format), &late);
+  ar->stale -= entries;
+  *n_read += entries;
+  if (late.peak > info->peak) info->peak = late.peak;
+  info->saturated |= late.saturated;
+  return ADXL345_ERR_NONE;
+}
+
+// =============================================================================
+// local (static) code
+
+static int16_t abs16(int16_t v) { return (v < 0) ? -v : v; }
+
+static void rescale(adxl345_isample_t *samples, uint16_t n, uint8_t shift,
+                    int16_t full_scale, adxl345_autorange_info_t *info) {
+  int16_t peak = 0;
+  bool saturated = false;
+
+  for (uint16_t i = 0; i < n; i++) {
+    adxl345_isample_t *s = &samples[i];
+    int16_t ax = abs16(s->x);
+    int16_t ay = abs16(s->y);
+    int16_t az = abs16(s->z);
+    int16_t m = (ax > ay) ? ax : ay;
+    if (az > m) m = az;
+
+    if (m >= full_scale) saturated = true;
+    if (m > peak) peak = m;
+
+    s->x = (int16_t)(s->x * (1 << shift));
+    s->y = (int16_t)(s->y * (1 << shift));
+    s->z = (int16_t)(s->z * (1 << shift));
+  }
+  info->peak = (int16_t)(peak << shift);
+  info->saturated = saturated;
+}
@@ -0,0 +1,126 @@
+/** @file adxl345_autorange.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_AUTORANGE_H_
+#define _ADXL345_AUTORANGE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// types and definitions
+
+/** Samples delivered by the auto-ranger are in 1/256 g per LSB. */
+#define ADXL345_AUTORANGE_LSB_PER_G 256
+
+/**
+ * Describes one delivered batch.
+ */
+typedef struct {
+  adxl345_data_format_reg range;  ///< range the samples were taken at
+  int16_t peak;                   ///< largest |value|, in 1/256 g
+  bool saturated;                 ///< some sample hit the full-scale code
+  bool switched;                  ///< range changed after this batch
+} adxl345_autorange_info_t;
+
+/**
+ * Auto-ranging across +/-2, 4, 8 and 16 g.
+ *
+ * Every delivered sample is rescaled to 1/256 g per LSB whatever the range,
+ * so consumers see one continuous physical signal.  After each batch the peak
+ * is compared to the current full scale: at or above `up_pct` percent (or on
+ * saturation) the range steps up at once; below `down_pct` percent of the
+ * next lower range for `hold_batches` consecutive batches it steps down.
+ *
+ * Use with ADXL345_FULL_RES to keep 3.9 mg resolution in every range.
+ */
+typedef struct {
+  adxl345_t *adxl345;
+  uint8_t data_format;   ///< cached DATA_FORMAT
+  uint8_t min_range;     ///< lowest range to use (ADXL345_RANGE_xG)
+  uint8_t max_range;     ///< highest range to use (ADXL345_RANGE_xG)
+  uint8_t up_pct;        ///< step up at this % of full scale (default 90)
+  uint8_t down_pct;      ///< step down below this % of lower range (40)
+  uint16_t hold_batches; ///< quiet batches required to step down
+  uint16_t quiet;        ///< consecutive quiet batches seen
+  uint32_t switches;     ///< number of range changes made
+  uint8_t stale;         ///< FIFO entries still queued from before a switch
+  uint8_t stale_format;  ///< DATA_FORMAT those entries were taken at
+} adxl345_autorange_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Read DATA_FORMAT and start auto-ranging between min and max range.
+ *
+ * Returns ADXL345_ERR_PARAM if DATA_FORMAT is left-justified.
+ */
+adxl345_err_t adxl345_autorange_init(adxl345_autorange_t *ar,
+                                     adxl345_t *adxl345, uint8_t min_range,
+                                     uint8_t max_range, uint16_t hold_batches);
+
+/**
+ * @brief Rescale a batch in place to 1/256 g and decide the next range.
+ *
+ * Does not touch the bus.  Returns the range to use next; the caller should
+ * apply it with adxl345_autorange_apply() once the FIFO has been drained.
+ */
+uint8_t adxl345_autorange_process(adxl345_autorange_t *ar,
+                                  adxl345_isample_t *samples, uint16_t n,
+                                  adxl345_autorange_info_t *info);
+
+/**
+ * @brief Write a new range to DATA_FORMAT, preserving the other bits.
+ */
+adxl345_err_t adxl345_autorange_apply(adxl345_autorange_t *ar, uint8_t range);
+
+/**
+ * @brief Drain the FIFO, rescale, and switch range when needed.
+ *
+ * After a switch, every entry still queued is scaled at the old range: as
+ * many as fit in this call, the rest at the start of the next ones, so at
+ * most the one sample in conversion during the DATA_FORMAT write can be
+ * mis-scaled.  No further switch is made until they have all been read.
+ */
+adxl345_err_t adxl345_autorange_service(adxl345_autorange_t *ar,
+                                        adxl345_isample_t *dst,
+                                        uint8_t capacity, uint8_t *n_read,
+                                        adxl345_autorange_info_t *info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_AUTORANGE_H_ */
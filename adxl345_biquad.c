@@ -0,0 +1,186 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include <math.h>
+#include <string.h>
+#include "adxl345_biquad.h"
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// local types and definitions
+
+#define PI 3.14159265358979323846
+
+#define ONE_Q30 ((double)(1L << ADXL345_BIQUAD_FRAC_BITS))
+
+// =============================================================================
+// local (forward) declarations
+
+static int32_t to_q30(double v);
+
+static int32_t step(const adxl345_biquad_coefs_t *c, adxl345_biquad_state_t *s,
+                    int32_t x);
+
+static int16_t saturate16(int32_t v);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+adxl345_err_t adxl345_biquad_design(adxl345_biquad_coefs_t *coefs,
+                                    adxl345_biquad_type_t type, float f0_hz,
+                                    float fs_hz, float q) {
+  double w0, cw, alpha, a0, b0, b1, b2;
+
+  if ((f0_hz <= 0.0f) || (f0_hz >= fs_hz / 2.0f) || (q <= 0.0f)) {
+    return ADXL345_ERR_PARAM;
+  }
+
+  w0 = 2.0 * PI * f0_hz / fs_hz;
+  cw = cos(w0);
+  alpha = sin(w0) / (2.0 * q);
+  a0 = 1.0 + alpha;
+
+  switch (type) {
+  case ADXL345_BIQUAD_LOWPASS:
+    b0 = (1.0 - cw) / 2.0;
+    b1 = 1.0 - cw;
+    b2 = b0;
+    break;
+  case ADXL345_BIQUAD_HIGHPASS:
+    b0 = (1.0 + cw) / 2.0;
+    b1 = -(1.0 + cw);
+    b2 = b0;
+    break;
+  case ADXL345_BIQUAD_BANDPASS:
+    b0 = alpha;
+    b1 = 0.0;
+    b2 = -alpha;
+    break;
+  case ADXL345_BIQUAD_NOTCH:
+    b0 = 1.0;
+    b1 = -2.0 * cw;
+    b2 = 1.0;
+    break;
+  default:
+    return ADXL345_ERR_PARAM;
+  }
+
+  coefs->b0 = to_q30(b0 / a0);
+  coefs->b1 = to_q30(b1 / a0);
+  coefs->b2 = to_q30(b2 / a0);
+  coefs->a1 = to_q30(-2.0 * cw / a0);
+  coefs->a2 = to_q30((1.0 - alpha) / a0);
+  return ADXL345_ERR_NONE;
+}
+
+void adxl345_biquad_init(adxl345_biquad_t *bq) {
+  bq->n_sections = 0;
+  adxl345_biquad_reset(bq);
+}
+
+adxl345_err_t adxl345_biquad_add(adxl345_biquad_t *bq,
+                                 adxl345_biquad_type_t type, float f0_hz,
+                                 float fs_hz, float q) {
+  adxl345_biquad_coefs_t coefs;
+  adxl345_err_t err;
+
+  err = adxl345_biquad_design(&coefs, type, f0_hz, fs_hz, q);
+  if (err != ADXL345_ERR_NONE) return err;
+  return adxl345_biquad_add_coefs(bq, &coefs);
+}
+
+adxl345_err_t adxl345_biquad_add_coefs(adxl345_biquad_t *bq,
+                                       const adxl345_biquad_coefs_t *coefs) {
+  if (bq->n_sections >= ADXL345_BIQUAD_MAX_SECTIONS) return ADXL345_ERR_PARAM;
+  bq->coefs[bq->n_sections] = *coefs;
+  memset(bq->state[bq->n_sections], 0, sizeof(bq->state[0]));
+  bq->n_sections += 1;
+  return ADXL345_ERR_NONE;
+}
+
+void adxl345_biquad_reset(adxl345_biquad_t *bq) {
+  memset(bq->state, 0, sizeof(bq->state));
+}
+
+void adxl345_biquad_process(adxl345_biquad_t *bq, adxl345_isample_t *samples,
+                            uint16_t n) {
+  uint8_t n_sections = bq->n_sections;
+
+  if (n_sections == 0) return;
+
+  for (uint16_t i = 0; i < n; i++) {
+    adxl345_isample_t *p = &samples[i];
+    int32_t x = p->x;
+    int32_t y = p->y;
+    int32_t z = p->z;
+
+    for (uint8_t k = 0; k < n_sections; k++) {
+      const adxl345_biquad_coefs_t *c = &bq->coefs[k];
+      x = step(c, &bq->state[k][0], x);
+      y = step(c, &bq->state[k][1], y);
+      z = step(c, &bq->state[k][2], z);
+    }
+    p->x = saturate16(x);
+    p->y = saturate16(y);
+    p->z = saturate16(z);
+  }
+}
+
+// =============================================================================
+// local (static) code
+
+static int32_t to_q30(double v) {
+  double scaled = v * ONE_Q30;
+  if (scaled >= 2.0 * ONE_Q30) return INT32_MAX;
+  if (scaled < -2.0 * ONE_Q30) return INT32_MIN;
+  return (int32_t)lround(scaled);
+}
+
+static int32_t step(const adxl345_biquad_coefs_t *c, adxl345_biquad_state_t *s,
+                    int32_t x) {
+  int64_t acc = (int64_t)c->b0 * x + (int64_t)c->b1 * s->x1 +
+                (int64_t)c->b2 * s->x2 - (int64_t)c->a1 * s->y1 -
+                (int64_t)c->a2 * s->y2 + s->err;
+  int32_t y = (int32_t)(acc >> ADXL345_BIQUAD_FRAC_BITS);
+
+  s->err = (int32_t)(acc - ((int64_t)y << ADXL345_BIQUAD_FRAC_BITS));
+  s->x2 = s->x1;
+  s->x1 = x;
+  s->y2 = s->y1;
+  s->y1 = y;
+  return y;
+}
+
+static int16_t saturate16(int32_t v) {
+  if (v > INT16_MAX) return INT16_MAX;
+  if (v < INT16_MIN) return INT16_MIN;
+  return (int16_t)v;
+}
@@ -0,0 +1,135 @@
+/** @file adxl345_biquad.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_BIQUAD_H_
+#define _ADXL345_BIQUAD_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdint.h>
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// types and definitions
+
+#define ADXL345_BIQUAD_MAX_SECTIONS 4
+
+/** Coefficients are Q2.30: 1.0 is 1 << 30, range [-2, 2). */
+#define ADXL345_BIQUAD_FRAC_BITS 30
+
+typedef enum {
+  ADXL345_BIQUAD_LOWPASS,
+  ADXL345_BIQUAD_HIGHPASS,
+  ADXL345_BIQUAD_BANDPASS,  ///< 0 dB at the centre frequency
+  ADXL345_BIQUAD_NOTCH,
+} adxl345_biquad_type_t;
+
+/**
+ * y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2], with a0
+ * normalised to 1.
+ */
+typedef struct {
+  int32_t b0;
+  int32_t b1;
+  int32_t b2;
+  int32_t a1;
+  int32_t a2;
+} adxl345_biquad_coefs_t;
+
+/** Direct form I state of one section on one axis. */
+typedef struct {
+  int32_t x1;
+  int32_t x2;
+  int32_t y1;
+  int32_t y2;
+  int32_t err;  ///< truncation error fed back into the next output
+} adxl345_biquad_state_t;
+
+/**
+ * Cascade of up to four biquad sections, applied to all three axes.
+ *
+ * Direct form I with 64-bit accumulation and first-order error feedback, so
+ * low cutoffs relative to the ODR (e.g. a 0.5 Hz high-pass at 3200 Hz for
+ * gravity removal) stay quiet and stable.  Inter-section values are kept at
+ * 32 bits; only the final output is saturated to 16 bits.
+ */
+typedef struct {
+  adxl345_biquad_coefs_t coefs[ADXL345_BIQUAD_MAX_SECTIONS];
+  adxl345_biquad_state_t state[ADXL345_BIQUAD_MAX_SECTIONS][3];
+  uint8_t n_sections;
+} adxl345_biquad_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Compute coefficients from the RBJ cookbook formulas.
+ *
+ * Returns ADXL345_ERR_PARAM unless 0 < f0_hz < fs_hz / 2 and q > 0.
+ */
+adxl345_err_t adxl345_biquad_design(adxl345_biquad_coefs_t *coefs,
+                                    adxl345_biquad_type_t type, float f0_hz,
+                                    float fs_hz, float q);
+
+/**
+ * @brief Start an empty cascade.  With no sections, process is a no-op.
+ */
+void adxl345_biquad_init(adxl345_biquad_t *bq);
+
+/**
+ * @brief Design a section and append it to the cascade.
+ */
+adxl345_err_t adxl345_biquad_add(adxl345_biquad_t *bq,
+                                 adxl345_biquad_type_t type, float f0_hz,
+                                 float fs_hz, float q);
+
+/**
+ * @brief Append a section with precomputed coefficients.
+ */
+adxl345_err_t adxl345_biquad_add_coefs(adxl345_biquad_t *bq,
+                                       const adxl345_biquad_coefs_t *coefs);
+
+/**
+ * @brief Clear the filter history, keeping the coefficients.
+ */
+void adxl345_biquad_reset(adxl345_biquad_t *bq);
+
+/**
+ * @brief Filter n samples in place.
+ */
+void adxl345_biquad_process(adxl345_biquad_t *bq, adxl345_isample_t *samples,
+                            uint16_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_BIQUAD_H_ */
@@ -0,0 +1,166 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include "adxl345_burst.h"
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// local types and definitions
+
+#define ACT_INACT_INTS (ADXL345_ACTIVITY_INT | ADXL345_INACTIVITY_INT)
+
+// =============================================================================
+// local (forward) declarations
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+adxl345_err_t adxl345_burst_init(adxl345_burst_t *burst, adxl345_t *adxl345,
+                                 const adxl345_burst_config_t *config) {
+  adxl345_err_t err;
+
+  burst->adxl345 = adxl345;
+  burst->config = *config;
+  burst->state = ADXL345_BURST_IDLE;
+  burst->switch_pending = false;
+  burst->position = 0;
+  burst->bursts = 0;
+
+  err = adxl345_write_reg(adxl345, ADXL345_REG_THRESH_ACT, config->thresh_act,
+                          true);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  err = adxl345_write_reg(adxl345, ADXL345_REG_THRESH_INACT,
+                          config->thresh_inact, true);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  err = adxl345_write_reg(adxl345, ADXL345_REG_TIME_INACT, config->time_inact,
+                          true);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  err = adxl345_write_reg(adxl345, ADXL345_REG_ACT_INACT_CTL,
+                          config->act_inact_ctl, true);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  return adxl345_burst_enter(burst, ADXL345_BURST_IDLE);
+}
+
+adxl345_err_t adxl345_burst_service(adxl345_burst_t *burst,
+                                    adxl345_isample_t *dst, uint8_t capacity,
+                                    uint8_t *n_read, bool *marked,
+                                    adxl345_rate_marker_t *marker) {
+  uint8_t source;
+  uint8_t available;
+  uint8_t entries;
+  adxl345_burst_state_t next;
+  adxl345_err_t err;
+
+  *n_read = 0;
+  *marked = false;
+
+  err = adxl345_read_reg(burst->adxl345, ADXL345_REG_INT_SOURCE, &source);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  if ((burst->state == ADXL345_BURST_IDLE) &&
+      (source & ADXL345_ACTIVITY_INT)) {
+    burst->switch_pending = true;
+  } else if ((burst->state == ADXL345_BURST_ACTIVE) &&
+             (source & ADXL345_INACTIVITY_INT)) {
+    burst->switch_pending = true;
+  }
+
+  err = adxl345_available_samples(burst->adxl345, &available);
+  if (err != ADXL345_ERR_NONE) return err;
+  entries = (available > capacity) ? capacity : available;
+
+  err = adxl345_get_isamples(burst->adxl345, dst, entries);
+  if (err != ADXL345_ERR_NONE) return err;
+  *n_read = entries;
+  burst->position += entries;
+
+  if (!burst->switch_pending) return ADXL345_ERR_NONE;
+
+  // Wait while dst is what limits the drain.  Otherwise switch now: at the
+  // high rates the FIFO is never seen empty, and the few entries taken since
+  // the drain are discarded by the pass through bypass.
+  if (available > capacity) return ADXL345_ERR_NONE;
+
+  next = (burst->state == ADXL345_BURST_IDLE) ? ADXL345_BURST_ACTIVE
+                                               : ADXL345_BURST_IDLE;
+  err = adxl345_burst_enter(burst, next);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  *marked = true;
+  marker->position = burst->position;
+  marker->state = next;
+  marker->rate = (next == ADXL345_BURST_ACTIVE) ? burst->config.burst_rate
+                                                : burst->config.idle_rate;
+  marker->odr_mhz = adxl345_rate_to_mhz(marker->rate);
+  return ADXL345_ERR_NONE;
+}
+
+adxl345_err_t adxl345_burst_enter(adxl345_burst_t *burst,
+                                  adxl345_burst_state_t state) {
+  bool active = (state == ADXL345_BURST_ACTIVE);
+  uint8_t rate = active ? burst->config.burst_rate : burst->config.idle_rate;
+  uint8_t fifo_ctl =
+      active ? burst->config.burst_fifo_ctl : burst->config.idle_fifo_ctl;
+  uint8_t source;
+  adxl345_err_t err;
+
+  // Passing through bypass discards anything taken at the old rate between
+  // the last drain and the BW_RATE write.
+  err = adxl345_write_reg(burst->adxl345, ADXL345_REG_FIFO_CTL,
+                          ADXL345_FIFO_MODE_BYPASS, false);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  err = adxl345_update_reg(burst->adxl345, ADXL345_REG_BW_RATE, 0x0F, rate);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  err = adxl345_write_reg(burst->adxl345, ADXL345_REG_FIFO_CTL, fifo_ctl,
+                          true);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  // arm the event that ends this state, and clear anything already latched
+  err = adxl345_update_reg(burst->adxl345, ADXL345_REG_INT_ENABLE,
+                           ACT_INACT_INTS,
+                           active ? ADXL345_INACTIVITY_INT
+                                  : ADXL345_ACTIVITY_INT);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  err = adxl345_read_reg(burst->adxl345, ADXL345_REG_INT_SOURCE, &source);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  if (active && (burst->state != ADXL345_BURST_ACTIVE)) burst->bursts += 1;
+  burst->state = state;
+  burst->switch_pending = false;
+  return ADXL345_ERR_NONE;
+}
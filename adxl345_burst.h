@@ -0,0 +1,127 @@
+/** @file adxl345_burst.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_BURST_H_
+#define _ADXL345_BURST_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// types and definitions
+
+typedef enum {
+  ADXL345_BURST_IDLE,    ///< monitoring at the low rate
+  ADXL345_BURST_ACTIVE,  ///< capturing at the high rate
+} adxl345_burst_state_t;
+
+typedef struct {
+  adxl345_bw_rate_reg idle_rate;   ///< BW_RATE while idle, e.g. RATE_100
+  adxl345_bw_rate_reg burst_rate;  ///< BW_RATE while active, e.g. RATE_3200
+  uint8_t idle_fifo_ctl;           ///< FIFO_CTL while idle
+  uint8_t burst_fifo_ctl;          ///< FIFO_CTL while active
+  uint8_t thresh_act;              ///< THRESH_ACT, 62.5 mg/LSB
+  uint8_t thresh_inact;            ///< THRESH_INACT, 62.5 mg/LSB
+  uint8_t time_inact;              ///< TIME_INACT, seconds
+  uint8_t act_inact_ctl;           ///< ACT_INACT_CTL axis / coupling bits
+} adxl345_burst_config_t;
+
+/**
+ * Marks the point in the delivered sample stream where the rate changed.
+ * Samples delivered before `position` were taken at the old rate, samples
+ * from `position` on at `odr_mhz`.
+ */
+typedef struct {
+  uint32_t position;            ///< stream offset of first new-rate sample
+  adxl345_burst_state_t state;  ///< state entered
+  adxl345_bw_rate_reg rate;     ///< BW_RATE rate code now in effect
+  uint32_t odr_mhz;             ///< the new output data rate
+} adxl345_rate_marker_t;
+
+/**
+ * Adaptive ODR engine.
+ *
+ * Idles at a low data rate with ADXL345_ACTIVITY_INT armed.  When activity
+ * fires, it drains the remaining low-rate samples, switches BW_RATE and
+ * FIFO_CTL to the burst settings, and arms ADXL345_INACTIVITY_INT instead.
+ * When inactivity fires it drains and drops back to idle.  Each switch is
+ * reported as a marker so downstream stages (e.g. adxl345_seq_set_odr(),
+ * adxl345_ts_reset()) can follow the rate change.
+ */
+typedef struct {
+  adxl345_t *adxl345;
+  adxl345_burst_config_t config;
+  adxl345_burst_state_t state;
+  bool switch_pending;  ///< event seen, waiting for the FIFO to drain
+  uint32_t position;    ///< samples delivered so far
+  uint32_t bursts;      ///< number of idle -> active transitions
+} adxl345_burst_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Program thresholds and enter the idle state.
+ *
+ * The device should be stopped or freshly reset; measurement is left as is.
+ */
+adxl345_err_t adxl345_burst_init(adxl345_burst_t *burst, adxl345_t *adxl345,
+                                 const adxl345_burst_config_t *config);
+
+/**
+ * @brief Check for activity / inactivity, drain the FIFO and switch rates.
+ *
+ * Reads INT_SOURCE once, then up to capacity samples from the FIFO into dst.
+ * A rate switch is made once a call has read every entry the FIFO held, so
+ * the samples returned before a marker are all at the old rate; the few
+ * taken during the switch itself are dropped.  *marked is set when a
+ * switch was made during this call, in which case *marker describes it and
+ * marker->position equals the position after this batch.
+ */
+adxl345_err_t adxl345_burst_service(adxl345_burst_t *burst,
+                                    adxl345_isample_t *dst, uint8_t capacity,
+                                    uint8_t *n_read, bool *marked,
+                                    adxl345_rate_marker_t *marker);
+
+/**
+ * @brief Force a state, e.g. to start a burst on demand.
+ */
+adxl345_err_t adxl345_burst_enter(adxl345_burst_t *burst,
+                                  adxl345_burst_state_t state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_BURST_H_ */
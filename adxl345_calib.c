@@ -0,0 +1,217 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include "adxl345_calib.h"
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// local types and definitions
+
+#define FIFO_DEPTH 32
+
+#define MAX_AVERAGE 8192
+
+// one OFSx step in 1/256 g with 8 fractional bits
+#define OFS_STEP_Q8 (ADXL345_CALIB_LSB_PER_OFS << 8)
+
+// =============================================================================
+// local (forward) declarations
+
+static void accumulate(adxl345_calib_t *cal, const adxl345_isample_t *samples,
+                       uint8_t n);
+
+static int32_t div_round(int64_t num, int64_t den);
+
+static int16_t correct(int16_t v, int32_t offset_q8, int32_t gain_q16);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+adxl345_err_t adxl345_calib_init(adxl345_calib_t *cal, adxl345_t *adxl345,
+                                 uint16_t n_average, uint16_t settle) {
+  uint8_t data_format;
+  adxl345_err_t err;
+
+  if ((n_average == 0) || (n_average > MAX_AVERAGE)) return ADXL345_ERR_PARAM;
+
+  err = adxl345_read_reg(adxl345, ADXL345_REG_DATA_FORMAT, &data_format);
+  if (err != ADXL345_ERR_NONE) return err;
+  if (data_format & ADXL345_LEFT_JUSTIFY) return ADXL345_ERR_PARAM;
+
+  cal->adxl345 = adxl345;
+  cal->shift = adxl345_format_shift(data_format);
+  cal->n_average = n_average;
+  cal->settle = settle;
+  cal->count = 0;
+  cal->position = ADXL345_CALIB_X_UP;
+  cal->captured = 0;
+  adxl345_calib_identity(&cal->coefs);
+
+  return adxl345_calib_write_offsets(adxl345, &cal->coefs);
+}
+
+adxl345_err_t adxl345_calib_begin(adxl345_calib_t *cal,
+                                  adxl345_calib_position_t position) {
+  if (position >= ADXL345_CALIB_POSITIONS) return ADXL345_ERR_PARAM;
+
+  cal->position = position;
+  cal->count = 0;
+  cal->sum[0] = cal->sum[1] = cal->sum[2] = 0;
+  cal->captured &= ~(1 << position);
+  return ADXL345_ERR_NONE;
+}
+
+adxl345_err_t adxl345_calib_service(adxl345_calib_t *cal, bool *done) {
+  adxl345_isample_t batch[FIFO_DEPTH];
+  uint8_t entries;
+  adxl345_err_t err;
+
+  *done = (cal->captured & (1 << cal->position)) != 0;
+  if (*done) return ADXL345_ERR_NONE;
+
+  err = adxl345_available_samples(cal->adxl345, &entries);
+  if (err != ADXL345_ERR_NONE) return err;
+  if (entries > FIFO_DEPTH) entries = FIFO_DEPTH;
+
+  err = adxl345_get_isamples(cal->adxl345, batch, entries);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  accumulate(cal, batch, entries);
+  *done = (cal->captured & (1 << cal->position)) != 0;
+  return ADXL345_ERR_NONE;
+}
+
+adxl345_err_t adxl345_calib_solve(adxl345_calib_t *cal) {
+  adxl345_calib_coefs_t coefs;
+
+  if (cal->captured != (1 << ADXL345_CALIB_POSITIONS) - 1) {
+    return ADXL345_ERR_PARAM;
+  }
+
+  for (int axis = 0; axis < 3; axis++) {
+    int32_t up = cal->mean_q8[2 * axis][axis];
+    int32_t down = cal->mean_q8[2 * axis + 1][axis];
+    int32_t offset = div_round((int64_t)up + down, 2);
+    int32_t sens = div_round((int64_t)up - down, 2);
+    int32_t ofs;
+
+    if ((sens < (ADXL345_CALIB_MIN_LSB_PER_G << 8)) ||
+        (sens > (ADXL345_CALIB_MAX_LSB_PER_G << 8))) {
+      return ADXL345_ERR_PARAM;
+    }
+
+    // the part adds OFSx to every reading, so cancel the offset
+    ofs = div_round(-(int64_t)offset, OFS_STEP_Q8);
+    if (ofs > 127) ofs = 127;
+    if (ofs < -128) ofs = -128;
+
+    coefs.ofs[axis] = (int8_t)ofs;
+    coefs.offset_q8[axis] = offset + ofs * OFS_STEP_Q8;
+    coefs.gain_q16[axis] =
+        div_round((int64_t)ADXL345_CALIB_LSB_PER_G * ADXL345_CALIB_UNITY_GAIN *
+                      256,
+                  sens);
+  }
+
+  cal->coefs = coefs;
+  return adxl345_calib_write_offsets(cal->adxl345, &cal->coefs);
+}
+
+adxl345_err_t adxl345_calib_write_offsets(adxl345_t *adxl345,
+                                          const adxl345_calib_coefs_t *coefs) {
+  adxl345_err_t err;
+
+  err = adxl345_write_reg(adxl345, ADXL345_REG_OFSX, (uint8_t)coefs->ofs[0],
+                          true);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  err = adxl345_write_reg(adxl345, ADXL345_REG_OFSY, (uint8_t)coefs->ofs[1],
+                          true);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  return adxl345_write_reg(adxl345, ADXL345_REG_OFSZ, (uint8_t)coefs->ofs[2],
+                           true);
+}
+
+void adxl345_calib_identity(adxl345_calib_coefs_t *coefs) {
+  for (int axis = 0; axis < 3; axis++) {
+    coefs->ofs[axis] = 0;
+    coefs->offset_q8[axis] = 0;
+    coefs->gain_q16[axis] = ADXL345_CALIB_UNITY_GAIN;
+  }
+}
+
+void adxl345_calib_apply(const adxl345_calib_coefs_t *coefs,
+                         adxl345_isample_t *samples, uint16_t n) {
+  for (uint16_t i = 0; i < n; i++) {
+    adxl345_isample_t *s = &samples[i];
+    s->x = correct(s->x, coefs->offset_q8[0], coefs->gain_q16[0]);
+    s->y = correct(s->y, coefs->offset_q8[1], coefs->gain_q16[1]);
+    s->z = correct(s->z, coefs->offset_q8[2], coefs->gain_q16[2]);
+  }
+}
+
+// =============================================================================
+// local (static) code
+
+static void accumulate(adxl345_calib_t *cal, const adxl345_isample_t *samples,
+                       uint8_t n) {
+  uint32_t end = (uint32_t)cal->settle + cal->n_average;
+
+  for (uint8_t i = 0; i < n; i++) {
+    if (cal->count >= end) break;
+    if (cal->count++ < cal->settle) continue;
+    cal->sum[0] += samples[i].x * (1 << cal->shift);
+    cal->sum[1] += samples[i].y * (1 << cal->shift);
+    cal->sum[2] += samples[i].z * (1 << cal->shift);
+  }
+
+  if (cal->count < end) return;
+
+  for (int axis = 0; axis < 3; axis++) {
+    cal->mean_q8[cal->position][axis] =
+        div_round((int64_t)cal->sum[axis] << 8, cal->n_average);
+  }
+  cal->captured |= 1 << cal->position;
+}
+
+static int32_t div_round(int64_t num, int64_t den) {
+  return (int32_t)((num < 0) ? (num - den / 2) / den : (num + den / 2) / den);
+}
+
+static int16_t correct(int16_t v, int32_t offset_q8, int32_t gain_q16) {
+  int64_t q8 = (int64_t)v * 256 - offset_q8;
+  int64_t out = (q8 * gain_q16 + (1 << 23)) >> 24;
+
+  if (out > INT16_MAX) return INT16_MAX;
+  if (out < INT16_MIN) return INT16_MIN;
+  return (int16_t)out;
+}
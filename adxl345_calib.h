@@ -0,0 +1,171 @@
+/** @file adxl345_calib.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_CALIB_H_
+#define _ADXL345_CALIB_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// types and definitions
+
+/** Calibrated samples are in 1/256 g per LSB. */
+#define ADXL345_CALIB_LSB_PER_G 256
+
+/** One OFSx LSB (15.6 mg) in 1/256 g units. */
+#define ADXL345_CALIB_LSB_PER_OFS 4
+
+/** Unity gain in adxl345_calib_coefs_t.gain_q16. */
+#define ADXL345_CALIB_UNITY_GAIN 65536
+
+/**
+ * Measured sensitivities outside this span (in LSB/g) are rejected as a
+ * wrong orientation rather than a real part.  The datasheet spread is 230 to
+ * 282 LSB/g.
+ */
+#define ADXL345_CALIB_MIN_LSB_PER_G 200
+#define ADXL345_CALIB_MAX_LSB_PER_G 320
+
+/**
+ * The six orientations.  X_UP means the +X axis points up (reads +1 g).
+ */
+typedef enum {
+  ADXL345_CALIB_X_UP,
+  ADXL345_CALIB_X_DOWN,
+  ADXL345_CALIB_Y_UP,
+  ADXL345_CALIB_Y_DOWN,
+  ADXL345_CALIB_Z_UP,
+  ADXL345_CALIB_Z_DOWN,
+  ADXL345_CALIB_POSITIONS,
+} adxl345_calib_position_t;
+
+/**
+ * Result of a calibration: the values for OFSX/Y/Z plus the residual that
+ * the 15.6 mg register step cannot express and the per-axis gain.  Plain
+ * data, so it can be stored and restored as is.
+ */
+typedef struct {
+  int8_t ofs[3];        ///< OFSX, OFSY, OFSZ register values
+  int32_t offset_q8[3]; ///< residual offset after OFSx, 1/256 g with 8 frac
+  int32_t gain_q16[3];  ///< gain correction, 65536 = unity
+} adxl345_calib_coefs_t;
+
+/**
+ * Six-position calibration.
+ *
+ * With the part held still in each orientation, n_average FIFO samples are
+ * summed (after discarding `settle` samples taken while it was being moved).
+ * The up and down readings of an axis give its offset, (up + down) / 2, and
+ * its sensitivity, (up - down) / 2.  The offset goes into the OFSx register
+ * rounded to the nearest 15.6 mg step; the rest of it and the gain are kept
+ * in the coefficients and applied to decoded samples by
+ * adxl345_calib_apply().
+ *
+ * Samples are drained a FIFO at a time, so at 3200 Hz a 256-sample average
+ * takes 80 ms per position.
+ */
+typedef struct {
+  adxl345_t *adxl345;
+  uint8_t shift;                 ///< left shift to 1/256 g for DATA_FORMAT
+  uint16_t n_average;            ///< samples summed per position
+  uint16_t settle;               ///< samples discarded per position
+  uint32_t count;                ///< samples seen in current position
+  uint8_t position;              ///< position being captured
+  uint8_t captured;              ///< bit n set once position n is done
+  int32_t sum[3];                ///< running sums for current position
+  int32_t mean_q8[ADXL345_CALIB_POSITIONS][3];  ///< 1/256 g, 8 frac bits
+  adxl345_calib_coefs_t coefs;   ///< result of adxl345_calib_solve()
+} adxl345_calib_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Prepare for calibration.
+ *
+ * Clears OFSX/Y/Z so that raw offsets are measured, and reads DATA_FORMAT.
+ * Returns ADXL345_ERR_PARAM if DATA_FORMAT is left-justified or n_average
+ * is 0 or above 8192.  The FIFO should be in stream or FIFO mode.
+ */
+adxl345_err_t adxl345_calib_init(adxl345_calib_t *cal, adxl345_t *adxl345,
+                                 uint16_t n_average, uint16_t settle);
+
+/**
+ * @brief Start capturing the given orientation.
+ */
+adxl345_err_t adxl345_calib_begin(adxl345_calib_t *cal,
+                                  adxl345_calib_position_t position);
+
+/**
+ * @brief Drain the FIFO into the current position's average.
+ *
+ * *done is set once n_average samples have been collected.
+ */
+adxl345_err_t adxl345_calib_service(adxl345_calib_t *cal, bool *done);
+
+/**
+ * @brief Solve for offsets and gains and write OFSX/Y/Z.
+ *
+ * Returns ADXL345_ERR_PARAM if a position has not been captured or an
+ * axis' sensitivity is implausible.
+ */
+adxl345_err_t adxl345_calib_solve(adxl345_calib_t *cal);
+
+/**
+ * @brief Write previously computed (e.g. stored) offsets to OFSX/Y/Z.
+ */
+adxl345_err_t adxl345_calib_write_offsets(adxl345_t *adxl345,
+                                          const adxl345_calib_coefs_t *coefs);
+
+/**
+ * @brief Set coefficients that do nothing: zero offsets and unity gain.
+ */
+void adxl345_calib_identity(adxl345_calib_coefs_t *coefs);
+
+/**
+ * @brief Apply the residual offset and gain to samples in place.
+ *
+ * Samples must be in 1/256 g (full resolution, the 2 g range, or the output
+ * of the auto-ranger) and taken with the OFSx registers from coefs in
+ * place.  Results saturate at the int16_t limits.
+ */
+void adxl345_calib_apply(const adxl345_calib_coefs_t *coefs,
+                         adxl345_isample_t *samples, uint16_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_CALIB_H_ */
@@ -0,0 +1,174 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include <stddef.h>
+#include "adxl345_capture.h"
+#include "adxl345.h"
+#include "adxl345_atomic.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// local types and definitions
+
+// FIFO depth in entries
+#define FIFO_DEPTH 32
+
+// =============================================================================
+// local (forward) declarations
+
+static adxl345_err_t collect(adxl345_capture_t *cap);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+adxl345_err_t adxl345_capture_init(adxl345_capture_t *cap, adxl345_t *adxl345,
+                                   const adxl345_capture_config_t *config,
+                                   adxl345_isample_t *buf, uint16_t capacity,
+                                   adxl345_capture_fn on_capture, void *arg) {
+  uint8_t sources = config->sources;
+  adxl345_err_t err;
+
+  if ((config->pre == 0) || (config->pre > ADXL345_WATERMARK_MAX) ||
+      (sources == 0) || (buf == NULL) ||
+      (capacity < (uint32_t)config->pre + config->post)) {
+    return ADXL345_ERR_PARAM;
+  }
+
+  cap->adxl345 = adxl345;
+  cap->config = *config;
+  cap->buf = buf;
+  cap->capacity = capacity;
+  cap->state = ADXL345_CAPTURE_IDLE;
+  cap->count = 0;
+  cap->triggered = false;
+  cap->on_capture = on_capture;
+  cap->arg = arg;
+  cap->captures = 0;
+  cap->discontinuities = 0;
+
+  err = adxl345_update_reg(adxl345, ADXL345_REG_INT_MAP, sources,
+                           (config->pin == ADXL345_INT2) ? sources : 0);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  return adxl345_update_reg(adxl345, ADXL345_REG_INT_ENABLE, sources, sources);
+}
+
+adxl345_err_t adxl345_capture_arm(adxl345_capture_t *cap) {
+  uint8_t fifo_ctl = ADXL345_FIFO_MODE_TRIGGER | cap->config.pre;
+  uint8_t reg;
+  adxl345_err_t err;
+
+  if (cap->config.pin == ADXL345_INT2) fifo_ctl |= ADXL345_TRIGGER_INT2;
+
+  // passing through bypass empties the FIFO and clears the trigger bit
+  err = adxl345_write_reg(cap->adxl345, ADXL345_REG_FIFO_CTL,
+                          ADXL345_FIFO_MODE_BYPASS, false);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  // clear latched events so an old one does not fire the trigger at once
+  err = adxl345_read_reg(cap->adxl345, ADXL345_REG_INT_SOURCE, &reg);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  STORE_RELEASE(&cap->triggered, false);
+  cap->count = 0;
+
+  err = adxl345_write_reg(cap->adxl345, ADXL345_REG_FIFO_CTL, fifo_ctl, true);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  cap->state = ADXL345_CAPTURE_ARMED;
+  return ADXL345_ERR_NONE;
+}
+
+adxl345_err_t adxl345_capture_disarm(adxl345_capture_t *cap) {
+  cap->state = ADXL345_CAPTURE_IDLE;
+  return adxl345_write_reg(cap->adxl345, ADXL345_REG_FIFO_CTL,
+                           ADXL345_FIFO_MODE_BYPASS, true);
+}
+
+void adxl345_capture_isr(adxl345_capture_t *cap) {
+  STORE_RELEASE(&cap->triggered, true);
+}
+
+adxl345_err_t adxl345_capture_poll(adxl345_capture_t *cap) {
+  uint8_t status;
+  adxl345_err_t err;
+
+  if (cap->state == ADXL345_CAPTURE_IDLE) return ADXL345_ERR_NONE;
+
+  if (cap->state == ADXL345_CAPTURE_ARMED) {
+    if (cap->config.wait_for_isr && !LOAD_ACQUIRE(&cap->triggered)) {
+      return ADXL345_ERR_NONE;
+    }
+    err = adxl345_read_reg(cap->adxl345, ADXL345_REG_FIFO_STATUS, &status);
+    if (err != ADXL345_ERR_NONE) return err;
+    if ((status & ADXL345_FIFO_STATUS_TRIGGER) == 0) {
+      // the pin may have fired for a source not routed to the trigger
+      STORE_RELEASE(&cap->triggered, false);
+      return ADXL345_ERR_NONE;
+    }
+    cap->state = ADXL345_CAPTURE_COLLECTING;
+  }
+
+  return collect(cap);
+}
+
+// =============================================================================
+// local (static) code
+
+static adxl345_err_t collect(adxl345_capture_t *cap) {
+  uint16_t target = cap->config.pre + cap->config.post;
+  uint8_t entries;
+  adxl345_err_t err;
+
+  err = adxl345_available_samples(cap->adxl345, &entries);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  if ((entries >= FIFO_DEPTH) && (target - cap->count > FIFO_DEPTH)) {
+    // collection stopped while the FIFO was full: samples were skipped
+    cap->discontinuities += 1;
+  }
+  if (entries > target - cap->count) entries = target - cap->count;
+
+  err = adxl345_get_isamples(cap->adxl345, &cap->buf[cap->count], entries);
+  if (err != ADXL345_ERR_NONE) return err;
+  cap->count += entries;
+
+  if (cap->count < target) return ADXL345_ERR_NONE;
+
+  cap->captures += 1;
+  cap->state = ADXL345_CAPTURE_IDLE;
+  if (cap->on_capture != NULL) {
+    cap->on_capture(cap->arg, cap->buf, cap->count, cap->config.pre);
+  }
+  if (cap->config.auto_rearm) {
+    return adxl345_capture_arm(cap);
+  }
+  return adxl345_capture_disarm(cap);
+}
@@ -0,0 +1,131 @@
+/** @file adxl345_capture.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_CAPTURE_H_
+#define _ADXL345_CAPTURE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345.h"
+#include "adxl345_err.h"
+#include "adxl345_watermark.h"
+
+// =============================================================================
+// types and definitions
+
+typedef enum {
+  ADXL345_CAPTURE_IDLE,        ///< not armed
+  ADXL345_CAPTURE_ARMED,       ///< FIFO in trigger mode, waiting for event
+  ADXL345_CAPTURE_COLLECTING,  ///< event seen, draining pre + post samples
+} adxl345_capture_state_t;
+
+/**
+ * Called when a capture completes.  samples[0 .. pre-1] precede the trigger
+ * event and samples[pre .. n-1] follow it.  The buffer is reused when the
+ * capture re-arms, so copy out anything needed later.
+ */
+typedef void (*adxl345_capture_fn)(void *arg, const adxl345_isample_t *samples,
+                                   uint16_t n, uint8_t pre);
+
+typedef struct {
+  adxl345_interrupt_reg sources;  ///< interrupts that act as the trigger
+  adxl345_int_pin_t pin;          ///< pin the trigger sources are routed to
+  uint8_t pre;                    ///< pre-trigger depth, 1..31 samples
+  uint16_t post;                  ///< samples to keep after the event
+  bool auto_rearm;                ///< re-arm after each completed capture
+  bool wait_for_isr;              ///< no bus traffic until capture_isr()
+} adxl345_capture_config_t;
+
+/**
+ * Pre/post event capture using the FIFO's trigger mode.
+ *
+ * While armed, the FIFO keeps the most recent `pre` samples.  When one of the
+ * trigger sources fires on the configured pin, the FIFO freezes that history
+ * and keeps collecting until full; the capture drains it into the caller's
+ * buffer and keeps draining until `post` samples after the event have been
+ * collected.  If the FIFO fills before it is drained, later samples are not
+ * contiguous with earlier ones and `discontinuities` is incremented.
+ */
+typedef struct {
+  adxl345_t *adxl345;
+  adxl345_capture_config_t config;
+  adxl345_isample_t *buf;           ///< caller-supplied storage
+  uint16_t capacity;                ///< must be at least pre + post
+  adxl345_capture_state_t state;
+  uint16_t count;                   ///< samples collected so far
+  volatile uint32_t triggered;      ///< set by adxl345_capture_isr()
+  adxl345_capture_fn on_capture;    ///< completion callback
+  void *arg;                        ///< passed to on_capture
+  uint32_t captures;                ///< completed captures
+  uint32_t discontinuities;         ///< captures that saw a full FIFO
+} adxl345_capture_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Set up a capture.  Routes and enables the trigger sources, but does
+ * not arm.
+ */
+adxl345_err_t adxl345_capture_init(adxl345_capture_t *cap, adxl345_t *adxl345,
+                                   const adxl345_capture_config_t *config,
+                                   adxl345_isample_t *buf, uint16_t capacity,
+                                   adxl345_capture_fn on_capture, void *arg);
+
+/**
+ * @brief Clear the FIFO and put it in trigger mode.
+ */
+adxl345_err_t adxl345_capture_arm(adxl345_capture_t *cap);
+
+/**
+ * @brief Leave trigger mode and return the FIFO to bypass.
+ */
+adxl345_err_t adxl345_capture_disarm(adxl345_capture_t *cap);
+
+/**
+ * @brief Note that the trigger pin fired.  Safe to call from an interrupt.
+ */
+void adxl345_capture_isr(adxl345_capture_t *cap);
+
+/**
+ * @brief Advance the capture: detect the event, drain, complete and re-arm.
+ *
+ * Call regularly while armed, and promptly once collecting to avoid the FIFO
+ * filling up.
+ */
+adxl345_err_t adxl345_capture_poll(adxl345_capture_t *cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_CAPTURE_H_ */
@@ -0,0 +1,190 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include <stddef.h>
+#include <string.h>
+#include "adxl345_decim.h"
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// local types and definitions
+
+// bits of headroom the CIC may use above a 13-bit input
+#define CIC_MAX_GROWTH 18
+
+// adxl345_isample_t is three packed int16_t, walked one axis at a time
+#define AXIS_STRIDE 3
+
+typedef struct {
+  uint8_t cic_phase;
+  uint8_t fir_phase;
+  uint8_t head;
+} phases_t;
+
+// =============================================================================
+// local (forward) declarations
+
+static uint16_t run_axis(const adxl345_decim_t *dec, adxl345_decim_axis_t *ax,
+                         const int16_t *in, uint16_t n, int16_t *out,
+                         phases_t *ph);
+
+static int16_t fir(const adxl345_decim_t *dec, const int16_t *delay,
+                   uint8_t head);
+
+// =============================================================================
+// local storage
+
+const int16_t adxl345_decim_default_taps[ADXL345_DECIM_DEFAULT_TAPS] = {
+    -1,   2,     11,    -17,   -62,  66,    233,  -164, -668, 287,  1615,
+    -316, -3723, -344,  10786, 17358, 10786, -344, -3723, -316, 1615, 287,
+    -668, -164,  233,   66,    -62,  -17,   11,   2,    -1};
+
+// =============================================================================
+// public code
+
+adxl345_err_t adxl345_decim_init(adxl345_decim_t *dec, uint8_t order,
+                                 uint8_t log2_ratio, uint8_t fir_ratio,
+                                 const int16_t *taps, uint8_t n_taps,
+                                 adxl345_cycle_fn cycles) {
+  if (taps == NULL) {
+    taps = adxl345_decim_default_taps;
+    n_taps = ADXL345_DECIM_DEFAULT_TAPS;
+  }
+  if ((order == 0) || (order > ADXL345_DECIM_MAX_ORDER) ||
+      (order * log2_ratio > CIC_MAX_GROWTH) || (fir_ratio == 0) ||
+      (fir_ratio > ADXL345_DECIM_MAX_FIR_RATIO) || (n_taps == 0) ||
+      (n_taps > ADXL345_DECIM_MAX_TAPS)) {
+    return ADXL345_ERR_PARAM;
+  }
+
+  dec->taps = taps;
+  dec->n_taps = n_taps;
+  dec->order = order;
+  dec->log2_ratio = log2_ratio;
+  dec->fir_ratio = fir_ratio;
+  dec->cycles = cycles;
+  adxl345_decim_reset(dec);
+  return ADXL345_ERR_NONE;
+}
+
+void adxl345_decim_reset(adxl345_decim_t *dec) {
+  memset(dec->axis, 0, sizeof(dec->axis));
+  dec->cic_phase = 0;
+  dec->fir_phase = 0;
+  dec->head = 0;
+  dec->cycle_count = 0;
+  dec->sample_count = 0;
+}
+
+uint16_t adxl345_decim_process(adxl345_decim_t *dec,
+                               const adxl345_isample_t *in, uint16_t n,
+                               adxl345_isample_t *out) {
+  uint32_t start = (dec->cycles != NULL) ? dec->cycles() : 0;
+  phases_t ph;
+  uint16_t n_out = 0;
+
+  for (uint8_t a = 0; a < 3; a++) {
+    // every axis starts from the same phase and ends in the same one
+    ph.cic_phase = dec->cic_phase;
+    ph.fir_phase = dec->fir_phase;
+    ph.head = dec->head;
+    n_out = run_axis(dec, &dec->axis[a], &in->x + a, n, &out->x + a, &ph);
+  }
+  dec->cic_phase = ph.cic_phase;
+  dec->fir_phase = ph.fir_phase;
+  dec->head = ph.head;
+
+  if (dec->cycles != NULL) {
+    dec->cycle_count += (uint32_t)(dec->cycles() - start);
+    dec->sample_count += n;
+  }
+  return n_out;
+}
+
+uint32_t adxl345_decim_cycles_q8(const adxl345_decim_t *dec) {
+  if (dec->sample_count == 0) return 0;
+  return (uint32_t)((dec->cycle_count << 8) / dec->sample_count);
+}
+
+// =============================================================================
+// local (static) code
+
+static uint16_t run_axis(const adxl345_decim_t *dec, adxl345_decim_axis_t *ax,
+                         const int16_t *in, uint16_t n, int16_t *out,
+                         phases_t *ph) {
+  uint8_t order = dec->order;
+  uint8_t shift = order * dec->log2_ratio;
+  uint8_t cic_ratio_mask = (uint8_t)((1u << dec->log2_ratio) - 1);
+  uint16_t n_out = 0;
+
+  for (uint16_t i = 0; i < n; i++) {
+    // integrators run at the input rate; unsigned so wrap-around is defined
+    uint32_t v = (uint32_t)(int32_t)in[i * AXIS_STRIDE];
+    for (uint8_t k = 0; k < order; k++) {
+      ax->integ[k] += v;
+      v = ax->integ[k];
+    }
+    ph->cic_phase = (ph->cic_phase + 1) & cic_ratio_mask;
+    if (ph->cic_phase != 0) continue;
+
+    // combs run at the CIC output rate
+    for (uint8_t k = 0; k < order; k++) {
+      uint32_t d = v - ax->comb[k];
+      ax->comb[k] = v;
+      v = d;
+    }
+    ax->delay[ph->head] = (int16_t)((int32_t)v >> shift);
+    if (++ph->head == dec->n_taps) ph->head = 0;
+
+    if (++ph->fir_phase < dec->fir_ratio) continue;
+    ph->fir_phase = 0;
+    out[n_out * AXIS_STRIDE] = fir(dec, ax->delay, ph->head);
+    n_out += 1;
+  }
+  return n_out;
+}
+
+static int16_t fir(const adxl345_decim_t *dec, const int16_t *delay,
+                   uint8_t head) {
+  // head is the oldest entry; walk oldest to newest without a modulo
+  const int16_t *taps = dec->taps;
+  uint8_t n_taps = dec->n_taps;
+  uint8_t k = 0;
+  int32_t acc = 1 << 14;
+
+  for (uint8_t j = head; j < n_taps; j++) {
+    acc += (int32_t)taps[k++] * delay[j];
+  }
+  for (uint8_t j = 0; j < head; j++) {
+    acc += (int32_t)taps[k++] * delay[j];
+  }
+  acc >>= 15;
+  if (acc > INT16_MAX) return INT16_MAX;
+  if (acc < INT16_MIN) return INT16_MIN;
+  return (int16_t)acc;
+}
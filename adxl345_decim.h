@@ -0,0 +1,138 @@
+/** @file adxl345_decim.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_DECIM_H_
+#define _ADXL345_DECIM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdint.h>
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// types and definitions
+
+#define ADXL345_DECIM_MAX_ORDER 4   ///< CIC integrator / comb pairs
+#define ADXL345_DECIM_MAX_TAPS 32   ///< compensation FIR length
+#define ADXL345_DECIM_MAX_FIR_RATIO 4
+
+/** Number of taps in adxl345_decim_default_taps. */
+#define ADXL345_DECIM_DEFAULT_TAPS 31
+
+/**
+ * Default Q15 compensation filter, for a third order CIC followed by FIR
+ * decimation by 2.  Relative to the CIC output rate fc, the cascade is flat
+ * within 0.1% to 0.15 fc, -1 dB at 0.20 fc, -32 dB at 0.30 fc and below
+ * -80 dB from 0.35 fc, so after the final /2 aliases only land in the top
+ * fifth of the output band.  Designed for CIC ratios of 4 and up.
+ *
+ * For example, 3200 Hz in with CIC /8 and FIR /2 (200 Hz out): 0 dB to 60 Hz,
+ * -1.04 dB at 80 Hz, -8.7 dB at 100 Hz and -32.4 dB at 120 Hz.
+ */
+extern const int16_t adxl345_decim_default_taps[ADXL345_DECIM_DEFAULT_TAPS];
+
+/**
+ * Returns a free-running cycle counter, e.g. DWT->CYCCNT, or SysTick on
+ * parts without one (SysTick counts down: return its negation).
+ */
+typedef uint32_t (*adxl345_cycle_fn)(void);
+
+typedef struct {
+  uint32_t integ[ADXL345_DECIM_MAX_ORDER];  ///< integrators, wrap modulo 2^32
+  uint32_t comb[ADXL345_DECIM_MAX_ORDER];   ///< comb delay elements
+  int16_t delay[ADXL345_DECIM_MAX_TAPS];    ///< FIR delay line
+} adxl345_decim_axis_t;
+
+/**
+ * Two-stage decimator: an integer CIC filter decimating by a power of two,
+ * followed by a short Q15 FIR that corrects the CIC passband droop and
+ * decimates by a further 1 to 4.
+ *
+ * Each call runs axis by axis over the whole block, keeping one axis' state
+ * hot at a time.  There is no allocation; all state lives in the struct.
+ */
+typedef struct {
+  adxl345_decim_axis_t axis[3];
+  const int16_t *taps;   ///< Q15 FIR coefficients, sum about 32768
+  uint8_t n_taps;
+  uint8_t order;         ///< CIC order N
+  uint8_t log2_ratio;    ///< CIC decimation is 1 << log2_ratio
+  uint8_t fir_ratio;     ///< FIR decimation
+  uint8_t cic_phase;
+  uint8_t fir_phase;
+  uint8_t head;          ///< next FIR delay slot
+  adxl345_cycle_fn cycles;
+  uint64_t cycle_count;  ///< cycles spent in adxl345_decim_process()
+  uint32_t sample_count; ///< input samples processed
+} adxl345_decim_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Set up a decimator with total ratio (1 << log2_ratio) * fir_ratio.
+ *
+ * taps may be NULL to use adxl345_decim_default_taps.  cycles may be NULL if
+ * no profiling is wanted.  Returns ADXL345_ERR_PARAM if the CIC gain would
+ * not fit in 32 bits for 13-bit input (order * log2_ratio > 18).
+ */
+adxl345_err_t adxl345_decim_init(adxl345_decim_t *dec, uint8_t order,
+                                 uint8_t log2_ratio, uint8_t fir_ratio,
+                                 const int16_t *taps, uint8_t n_taps,
+                                 adxl345_cycle_fn cycles);
+
+/**
+ * @brief Clear the filter state and profiling counters.
+ */
+void adxl345_decim_reset(adxl345_decim_t *dec);
+
+/**
+ * @brief Filter and decimate n samples.
+ *
+ * out must have room for n / total ratio + 1 samples.  in and out may be the
+ * same buffer.  Returns the number of samples written.
+ */
+uint16_t adxl345_decim_process(adxl345_decim_t *dec,
+                               const adxl345_isample_t *in, uint16_t n,
+                               adxl345_isample_t *out);
+
+/**
+ * @brief Average cycles per input sample, in 1/256 cycle, since reset.
+ *
+ * Returns 0 when no cycle counter was given.
+ */
+uint32_t adxl345_decim_cycles_q8(const adxl345_decim_t *dec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_DECIM_H_ */
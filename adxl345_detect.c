@@ -0,0 +1,266 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include <math.h>
+#include <string.h>
+#include "adxl345_detect.h"
+#include "adxl345.h"
+#include "adxl345_err.h"
+#include "adxl345_math.h"
+
+// =============================================================================
+// local types and definitions
+
+#define PI 3.14159265358979323846
+
+// gravity estimate fractional bits
+#define GRAVITY_FRAC_BITS 4
+
+typedef struct {
+  adxl345_detect_event_t *events;
+  uint16_t capacity;
+  uint16_t count;
+} sink_t;
+
+// =============================================================================
+// local (forward) declarations
+
+static uint32_t mg_to_lsb(const adxl345_detect_config_t *config, uint16_t mg);
+
+static void emit(adxl345_detect_t *det, sink_t *sink,
+                 adxl345_detect_type_t type, uint32_t start,
+                 uint32_t duration, int32_t value);
+
+static void check_shock(adxl345_detect_t *det, sink_t *sink, uint32_t mag_sq);
+
+static void check_freefall(adxl345_detect_t *det, sink_t *sink,
+                           uint32_t mag_sq);
+
+static void check_jerk(adxl345_detect_t *det, sink_t *sink,
+                       const adxl345_isample_t *s);
+
+static void check_tilt(adxl345_detect_t *det, sink_t *sink);
+
+static int32_t abs32(int32_t v);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+adxl345_err_t adxl345_detect_init(adxl345_detect_t *det,
+                                  const adxl345_detect_config_t *config) {
+  uint32_t lsb;
+  double c;
+
+  if ((config->data_format & ADXL345_LEFT_JUSTIFY) ||
+      (config->tilt_deg >= 90) || (config->tilt_shift > 12) ||
+      ((config->shock_mg != 0) && (config->shock_samples == 0)) ||
+      ((config->freefall_mg != 0) && (config->freefall_samples == 0))) {
+    return ADXL345_ERR_PARAM;
+  }
+
+  memset(det, 0, sizeof(*det));
+  det->config = *config;
+
+  lsb = mg_to_lsb(config, config->shock_mg);
+  det->shock_sq = lsb * lsb;
+  lsb = mg_to_lsb(config, config->freefall_mg);
+  det->freefall_sq = lsb * lsb;
+  det->jerk = (int16_t)mg_to_lsb(config, config->jerk_mg);
+  c = cos(config->tilt_deg * PI / 180.0);
+  det->tilt_cos2_q15 = (uint32_t)lround(c * c * 32768.0);
+  det->jerk_armed = true;
+  return ADXL345_ERR_NONE;
+}
+
+uint16_t adxl345_detect_feed(adxl345_detect_t *det,
+                             const adxl345_isample_t *samples, uint16_t n,
+                             uint64_t t_first_us, uint32_t period_q8,
+                             adxl345_detect_event_t *events,
+                             uint16_t capacity) {
+  sink_t sink = {events, capacity, 0};
+  uint8_t shift = det->config.tilt_shift;
+
+  det->batch_index = det->index;
+  det->batch_t_us = t_first_us;
+  det->period_q8 = period_q8;
+
+  for (uint16_t i = 0; i < n; i++) {
+    const adxl345_isample_t *s = &samples[i];
+    uint32_t mag_sq = (uint32_t)((int32_t)s->x * s->x) +
+                      (uint32_t)((int32_t)s->y * s->y) +
+                      (uint32_t)((int32_t)s->z * s->z);
+
+    if (!det->primed) {
+      det->prev = *s;
+      det->gravity[0] = (int32_t)s->x << GRAVITY_FRAC_BITS;
+      det->gravity[1] = (int32_t)s->y << GRAVITY_FRAC_BITS;
+      det->gravity[2] = (int32_t)s->z << GRAVITY_FRAC_BITS;
+      det->ref[0] = s->x;
+      det->ref[1] = s->y;
+      det->ref[2] = s->z;
+      det->primed = true;
+    }
+
+    if (det->shock_sq != 0) check_shock(det, &sink, mag_sq);
+    if (det->freefall_sq != 0) check_freefall(det, &sink, mag_sq);
+    if (det->jerk != 0) check_jerk(det, &sink, s);
+    if (det->config.tilt_deg != 0) {
+      det->gravity[0] +=
+          (((int32_t)s->x << GRAVITY_FRAC_BITS) - det->gravity[0]) >> shift;
+      det->gravity[1] +=
+          (((int32_t)s->y << GRAVITY_FRAC_BITS) - det->gravity[1]) >> shift;
+      det->gravity[2] +=
+          (((int32_t)s->z << GRAVITY_FRAC_BITS) - det->gravity[2]) >> shift;
+      check_tilt(det, &sink);
+    }
+    det->prev = *s;
+    det->index += 1;
+  }
+  return sink.count;
+}
+
+// =============================================================================
+// local (static) code
+
+static uint32_t mg_to_lsb(const adxl345_detect_config_t *config, uint16_t mg) {
+  double g_per_lsb =
+      ADXL345_2G_SCALE * (1 << adxl345_format_shift(config->data_format));
+  return (uint32_t)lround(mg / 1000.0 / g_per_lsb);
+}
+
+static void emit(adxl345_detect_t *det, sink_t *sink,
+                 adxl345_detect_type_t type, uint32_t start,
+                 uint32_t duration, int32_t value) {
+  adxl345_detect_event_t *e;
+  // start may fall in an earlier batch, so the offset can be negative
+  int64_t offset = (int32_t)(start - det->batch_index);
+
+  if (sink->count >= sink->capacity) {
+    det->dropped += 1;
+    return;
+  }
+  e = &sink->events[sink->count++];
+  e->type = type;
+  e->t_us = det->batch_t_us + (offset * (int64_t)det->period_q8) / 256;
+  e->duration = duration;
+  e->value = value;
+}
+
+static void check_shock(adxl345_detect_t *det, sink_t *sink, uint32_t mag_sq) {
+  adxl345_detect_run_t *r = &det->shock;
+
+  if (mag_sq >= det->shock_sq) {
+    if (r->run++ == 0) {
+      r->start = det->index;
+      r->extreme = 0;
+    }
+    if ((int32_t)mag_sq > r->extreme) r->extreme = (int32_t)mag_sq;
+    return;
+  }
+  if (r->run >= det->config.shock_samples) {
+    emit(det, sink, ADXL345_DETECT_SHOCK, r->start, r->run,
+         adxl345_isqrt32((uint32_t)r->extreme));
+  }
+  r->run = 0;
+}
+
+static void check_freefall(adxl345_detect_t *det, sink_t *sink,
+                           uint32_t mag_sq) {
+  adxl345_detect_run_t *r = &det->freefall;
+
+  if (mag_sq < det->freefall_sq) {
+    if (r->run++ == 0) {
+      r->start = det->index;
+      r->extreme = INT32_MAX;
+    }
+    if ((int32_t)mag_sq < r->extreme) r->extreme = (int32_t)mag_sq;
+    return;
+  }
+  // a short dip (vibration, a bump) does not qualify: only a sustained one
+  if (r->run >= det->config.freefall_samples) {
+    emit(det, sink, ADXL345_DETECT_FREEFALL, r->start, r->run,
+         adxl345_isqrt32((uint32_t)r->extreme));
+  }
+  r->run = 0;
+}
+
+static void check_jerk(adxl345_detect_t *det, sink_t *sink,
+                       const adxl345_isample_t *s) {
+  int32_t dx = abs32((int32_t)s->x - det->prev.x);
+  int32_t dy = abs32((int32_t)s->y - det->prev.y);
+  int32_t dz = abs32((int32_t)s->z - det->prev.z);
+  int32_t d = (dx > dy) ? dx : dy;
+
+  if (dz > d) d = dz;
+  if (d >= det->jerk) {
+    if (det->jerk_armed) {
+      emit(det, sink, ADXL345_DETECT_JERK, det->index, 1, d);
+      det->jerk_armed = false;
+    }
+  } else if (d < det->jerk / 2) {
+    // re-arm with hysteresis so one ringing transient reports once
+    det->jerk_armed = true;
+  }
+}
+
+static void check_tilt(adxl345_detect_t *det, sink_t *sink) {
+  adxl345_detect_run_t *r = &det->tilt;
+  int32_t gx = det->gravity[0] >> GRAVITY_FRAC_BITS;
+  int32_t gy = det->gravity[1] >> GRAVITY_FRAC_BITS;
+  int32_t gz = det->gravity[2] >> GRAVITY_FRAC_BITS;
+  int64_t dot = (int64_t)gx * det->ref[0] + (int64_t)gy * det->ref[1] +
+                (int64_t)gz * det->ref[2];
+  uint64_t gg = (uint64_t)((int64_t)gx * gx + (int64_t)gy * gy +
+                           (int64_t)gz * gz);
+  uint64_t rr = (uint64_t)((int64_t)det->ref[0] * det->ref[0] +
+                           (int64_t)det->ref[1] * det->ref[1] +
+                           (int64_t)det->ref[2] * det->ref[2]);
+  uint32_t norm;
+  int32_t cos_q15;
+
+  // cos(angle) >= threshold, compared squared so no root is needed per sample
+  if ((dot >= 0) && ((uint64_t)(dot * dot) >=
+                     ((gg * rr) >> 15) * (uint64_t)det->tilt_cos2_q15)) {
+    r->run = 0;
+    return;
+  }
+  if (r->run++ == 0) r->start = det->index;
+  if (r->run < det->config.tilt_samples) return;
+
+  norm = adxl345_isqrt64(gg) * adxl345_isqrt64(rr);
+  cos_q15 = (norm == 0) ? 32768 : (int32_t)((dot * 32768) / norm);
+  emit(det, sink, ADXL345_DETECT_TILT, r->start, r->run, cos_q15);
+  det->ref[0] = gx;
+  det->ref[1] = gy;
+  det->ref[2] = gz;
+  r->run = 0;
+}
+
+static int32_t abs32(int32_t v) { return (v < 0) ? -v : v; }
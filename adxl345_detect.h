@@ -0,0 +1,136 @@
+/** @file adxl345_detect.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_DETECT_H_
+#define _ADXL345_DETECT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// types and definitions
+
+typedef enum {
+  ADXL345_DETECT_SHOCK,     ///< value: peak |a| in LSB
+  ADXL345_DETECT_FREEFALL,  ///< value: lowest |a| in LSB
+  ADXL345_DETECT_JERK,      ///< value: largest per-axis step in LSB
+  ADXL345_DETECT_TILT,      ///< value: cos(angle from old attitude), Q15
+} adxl345_detect_type_t;
+
+typedef struct {
+  adxl345_detect_type_t type;
+  uint64_t t_us;       ///< time of the first sample of the event
+  uint32_t duration;   ///< samples the condition held
+  int32_t value;       ///< see adxl345_detect_type_t
+} adxl345_detect_event_t;
+
+/**
+ * Detector settings.  A zero threshold disables that detector; an enabled
+ * shock or free-fall detector needs a qualifier of at least one sample.
+ */
+typedef struct {
+  uint8_t data_format;        ///< DATA_FORMAT in effect, for the mg scale
+  uint16_t shock_mg;          ///< |a| at or above this ...
+  uint16_t shock_samples;     ///< ... for this many samples is a shock
+  uint16_t freefall_mg;       ///< |a| below this ...
+  uint16_t freefall_samples;  ///< ... for this many samples is a free fall
+  uint16_t jerk_mg;           ///< step between consecutive samples
+  uint8_t tilt_deg;           ///< attitude change, 1 - 89 degrees ...
+  uint16_t tilt_samples;      ///< ... held for this many samples
+  uint8_t tilt_shift;         ///< gravity low-pass, time constant 2^n samples
+} adxl345_detect_config_t;
+
+typedef struct {
+  uint32_t run;     ///< consecutive samples meeting the condition
+  uint32_t start;   ///< sample index where the run began
+  int32_t extreme;  ///< running peak (or minimum) of the run
+} adxl345_detect_run_t;
+
+/**
+ * Software event detectors.
+ *
+ * Thresholds are in mg with sample-count qualifiers, so they can be much
+ * finer and stricter than the 62.5 mg THRESH_* registers.  Every detector
+ * is O(1) per sample.  Shock and free-fall events are reported when the
+ * condition ends, with its start time and duration; jerk when it first
+ * crosses; tilt once the new attitude has been held.
+ *
+ * Times come from the caller, typically adxl345_ts_time_of() for the first
+ * sample of the batch and adxl345_ts_period_q8().
+ */
+typedef struct {
+  adxl345_detect_config_t config;
+  uint32_t shock_sq;      ///< thresholds as squared magnitudes in LSB^2
+  uint32_t freefall_sq;
+  int16_t jerk;           ///< jerk threshold in LSB
+  uint32_t tilt_cos2_q15; ///< cos^2 of the tilt threshold
+  adxl345_detect_run_t shock;
+  adxl345_detect_run_t freefall;
+  adxl345_detect_run_t tilt;
+  bool jerk_armed;
+  bool primed;            ///< prev and gravity hold real data
+  adxl345_isample_t prev;
+  int32_t gravity[3];     ///< low-passed acceleration, Q4
+  int32_t ref[3];         ///< attitude the tilt detector compares to, LSB
+  uint32_t index;         ///< samples seen
+  uint32_t batch_index;   ///< index of the current batch's first sample
+  uint64_t batch_t_us;    ///< and its time
+  uint32_t period_q8;
+  uint32_t dropped;       ///< events lost to a full output array
+} adxl345_detect_t;
+
+// =============================================================================
+// declarations
+
+adxl345_err_t adxl345_detect_init(adxl345_detect_t *det,
+                                  const adxl345_detect_config_t *config);
+
+/**
+ * @brief Run the detectors over a batch.
+ *
+ * t_first_us is the time of samples[0] and period_q8 the sample period in
+ * 1/256 us.  Up to capacity events are written to events; the number written
+ * is returned and any excess is counted in det->dropped.
+ */
+uint16_t adxl345_detect_feed(adxl345_detect_t *det,
+                             const adxl345_isample_t *samples, uint16_t n,
+                             uint64_t t_first_us, uint32_t period_q8,
+                             adxl345_detect_event_t *events,
+                             uint16_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_DETECT_H_ */
@@ -0,0 +1,145 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include "adxl345_envelope.h"
+#include "adxl345.h"
+#include "adxl345_biquad.h"
+#include "adxl345_err.h"
+#include "adxl345_fft.h"
+
+// =============================================================================
+// local types and definitions
+
+// samples filtered per pass through the chain
+#define CHUNK 32
+
+// Q of the two sections of a 4th order Butterworth
+#define BUTTERWORTH4_Q1 0.5412f
+#define BUTTERWORTH4_Q2 1.3066f
+
+// envelope low-pass corner as a fraction of the decimated Nyquist rate
+#define ENVELOPE_CORNER 0.8f
+
+// =============================================================================
+// local (forward) declarations
+
+static int16_t rectify(int16_t v);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+adxl345_err_t adxl345_envelope_init(adxl345_envelope_t *env,
+                                    const adxl345_envelope_config_t *config) {
+  float fs = config->fs_hz;
+  float corner;
+  adxl345_err_t err;
+
+  if ((config->decim == 0) || (config->decim > ADXL345_ENVELOPE_MAX_DECIM) ||
+      (config->band_lo_hz >= config->band_hi_hz)) {
+    return ADXL345_ERR_PARAM;
+  }
+  corner = ENVELOPE_CORNER * fs / (2.0f * config->decim);
+
+  adxl345_biquad_init(&env->bandpass);
+  err = adxl345_biquad_add(&env->bandpass, ADXL345_BIQUAD_HIGHPASS,
+                           config->band_lo_hz, fs, 0.7071f);
+  if (err != ADXL345_ERR_NONE) return err;
+  err = adxl345_biquad_add(&env->bandpass, ADXL345_BIQUAD_LOWPASS,
+                           config->band_hi_hz, fs, 0.7071f);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  // The low-pass both smooths the rectified signal and keeps the carrier
+  // harmonics from aliasing into the decimated envelope.
+  adxl345_biquad_init(&env->lowpass);
+  err = adxl345_biquad_add(&env->lowpass, ADXL345_BIQUAD_LOWPASS, corner, fs,
+                           BUTTERWORTH4_Q1);
+  if (err != ADXL345_ERR_NONE) return err;
+  err = adxl345_biquad_add(&env->lowpass, ADXL345_BIQUAD_LOWPASS, corner, fs,
+                           BUTTERWORTH4_Q2);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  err = adxl345_fft_init(&env->fft, config->n, config->hop, config->n_average);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  env->decim = config->decim;
+  env->phase = 0;
+  return ADXL345_ERR_NONE;
+}
+
+void adxl345_envelope_reset(adxl345_envelope_t *env) {
+  adxl345_biquad_reset(&env->bandpass);
+  adxl345_biquad_reset(&env->lowpass);
+  adxl345_fft_reset(&env->fft);
+  env->phase = 0;
+}
+
+bool adxl345_envelope_feed(adxl345_envelope_t *env,
+                           const adxl345_isample_t *samples, uint16_t n) {
+  adxl345_isample_t buf[CHUNK];
+  bool completed = false;
+
+  while (n > 0) {
+    uint16_t chunk = (n > CHUNK) ? CHUNK : n;
+    uint16_t kept = 0;
+
+    for (uint16_t i = 0; i < chunk; i++) buf[i] = samples[i];
+    adxl345_biquad_process(&env->bandpass, buf, chunk);
+    for (uint16_t i = 0; i < chunk; i++) {
+      buf[i].x = rectify(buf[i].x);
+      buf[i].y = rectify(buf[i].y);
+      buf[i].z = rectify(buf[i].z);
+    }
+    adxl345_biquad_process(&env->lowpass, buf, chunk);
+
+    for (uint16_t i = 0; i < chunk; i++) {
+      if (env->phase == 0) buf[kept++] = buf[i];
+      if (++env->phase == env->decim) env->phase = 0;
+    }
+    completed |= adxl345_fft_feed(&env->fft, buf, kept);
+
+    samples += chunk;
+    n -= chunk;
+  }
+  return completed;
+}
+
+adxl345_err_t adxl345_envelope_spectrum(const adxl345_envelope_t *env,
+                                        adxl345_fft_axis_t axis,
+                                        uint16_t *mag) {
+  return adxl345_fft_spectrum(&env->fft, axis, mag);
+}
+
+// =============================================================================
+// local (static) code
+
+static int16_t rectify(int16_t v) {
+  if (v >= 0) return v;
+  return (v == INT16_MIN) ? INT16_MAX : -v;
+}
@@ -0,0 +1,116 @@
+/** @file adxl345_envelope.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_ENVELOPE_H_
+#define _ADXL345_ENVELOPE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345.h"
+#include "adxl345_biquad.h"
+#include "adxl345_err.h"
+#include "adxl345_fft.h"
+
+// =============================================================================
+// types and definitions
+
+#define ADXL345_ENVELOPE_MAX_DECIM 16
+
+typedef struct {
+  float fs_hz;        ///< input rate, e.g. 3200
+  float band_lo_hz;   ///< lower edge of the resonance band
+  float band_hi_hz;   ///< upper edge of the resonance band
+  uint8_t decim;      ///< envelope decimation, 1..ADXL345_ENVELOPE_MAX_DECIM
+  uint16_t n;         ///< envelope FFT length
+  uint16_t hop;       ///< envelope FFT hop
+  uint8_t n_average;  ///< envelope spectra per result
+} adxl345_envelope_config_t;
+
+/**
+ * Envelope (demodulation) analysis.
+ *
+ * A bearing defect strikes once per pass and rings a structural resonance;
+ * the defect rate shows up as modulation of that resonance rather than as a
+ * line of its own.  This stage isolates the resonance band with a 4th order
+ * band-pass, full-wave rectifies it, low-passes and decimates the result to
+ * the envelope rate, and feeds the envelope to an adxl345_fft engine.  The
+ * envelope spectrum then has lines at the defect frequencies.
+ *
+ * Envelope bin k is centred on k * fs / (decim * n).
+ */
+typedef struct {
+  adxl345_biquad_t bandpass;
+  adxl345_biquad_t lowpass;
+  adxl345_fft_t fft;
+  uint8_t decim;
+  uint8_t phase;
+} adxl345_envelope_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Design the filters and set up the envelope FFT.
+ *
+ * Returns ADXL345_ERR_PARAM if the band does not fit below fs / 2 or the
+ * FFT parameters are rejected by adxl345_fft_init().
+ */
+adxl345_err_t adxl345_envelope_init(adxl345_envelope_t *env,
+                                    const adxl345_envelope_config_t *config);
+
+/**
+ * @brief Clear filter state and the partial spectrum.
+ */
+void adxl345_envelope_reset(adxl345_envelope_t *env);
+
+/**
+ * @brief Run n input samples through the chain.
+ *
+ * Returns true if an envelope spectrum completed during this call; it can
+ * then be read with adxl345_envelope_spectrum() until the next completes.
+ */
+bool adxl345_envelope_feed(adxl345_envelope_t *env,
+                           const adxl345_isample_t *samples, uint16_t n);
+
+/**
+ * @brief Read the n/2 bins of the last envelope spectrum, as for
+ * adxl345_fft_spectrum().
+ */
+adxl345_err_t adxl345_envelope_spectrum(const adxl345_envelope_t *env,
+                                        adxl345_fft_axis_t axis,
+                                        uint16_t *mag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_ENVELOPE_H_ */
@@ -45,6 +45,7 @@ typedef enum {
   ADXL345_ERR_WRITE,     ///< error during write operation
   ADXL354_ERR_INIT,      ///< error during initialization
   ADXL345_ERR_VERIFY,    ///< value read did not equal written value
+  ADXL345_ERR_PARAM,     ///< invalid argument
 } adxl345_err_t;
 
 // =============================================================================
@@ -0,0 +1,137 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include <string.h>
+#include "adxl345_store_nvm.h"
+#include "adxl345_err.h"
+#include "adxl345_store.h"
+#include "hri_l22.h"
+
+// =============================================================================
+// local types and definitions
+
+#define ROW_SIZE (NVMCTRL_ROW_PAGES * NVMCTRL_PAGE_SIZE)
+
+// =============================================================================
+// local (forward) declarations
+
+static adxl345_err_t nvm_load(void *ctx, void *dst, uint16_t n);
+
+static adxl345_err_t nvm_save(void *ctx, const void *src, uint16_t n);
+
+static adxl345_err_t nvm_command(uint32_t addr, uint32_t cmd);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+void adxl345_store_nvm_init(adxl345_store_nvm_t *nvm, uint32_t row_addr,
+                            adxl345_store_backend_t *backend) {
+  nvm->row_addr = row_addr;
+  backend->load = nvm_load;
+  backend->save = nvm_save;
+  backend->ctx = nvm;
+}
+
+// =============================================================================
+// local (static) code
+
+static adxl345_err_t nvm_load(void *ctx, void *dst, uint16_t n) {
+  adxl345_store_nvm_t *nvm = (adxl345_store_nvm_t *)ctx;
+
+  if (n > ROW_SIZE) return ADXL345_ERR_PARAM;
+  // flash is memory mapped
+  memcpy(dst, (const void *)nvm->row_addr, n);
+  return ADXL345_ERR_NONE;
+}
+
+static adxl345_err_t nvm_save(void *ctx, const void *src, uint16_t n) {
+  adxl345_store_nvm_t *nvm = (adxl345_store_nvm_t *)ctx;
+  const uint8_t *bytes = (const uint8_t *)src;
+  adxl345_err_t err;
+
+  if ((n > ROW_SIZE) || (nvm->row_addr % ROW_SIZE != 0)) {
+    return ADXL345_ERR_PARAM;
+  }
+
+  err = nvm_command(nvm->row_addr, NVMCTRL_CTRLA_CMD_ER);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  for (uint16_t page = 0; page * NVMCTRL_PAGE_SIZE < n; page++) {
+    uint32_t addr = nvm->row_addr + page * NVMCTRL_PAGE_SIZE;
+    volatile uint32_t *dst = (volatile uint32_t *)addr;
+
+    err = nvm_command(addr, NVMCTRL_CTRLA_CMD_PBC);
+    if (err != ADXL345_ERR_NONE) return err;
+
+    // the page buffer only takes 16 or 32 bit writes
+    for (uint16_t i = 0; i < NVMCTRL_PAGE_SIZE; i += 4) {
+      uint16_t offset = page * NVMCTRL_PAGE_SIZE + i;
+      uint32_t word = 0xFFFFFFFFUL;
+      if (offset < n) {
+        uint16_t len = (n - offset < 4) ? n - offset : 4;
+        memcpy(&word, &bytes[offset], len);
+      }
+      dst[i / 4] = word;
+    }
+
+    err = nvm_command(addr, NVMCTRL_CTRLA_CMD_WP);
+    if (err != ADXL345_ERR_NONE) return err;
+  }
+
+  if (memcmp((const void *)nvm->row_addr, src, n) != 0) {
+    return ADXL345_ERR_VERIFY;
+  }
+  return ADXL345_ERR_NONE;
+}
+
+static adxl345_err_t nvm_command(uint32_t addr, uint32_t cmd) {
+  while (!hri_nvmctrl_get_INTFLAG_READY_bit(NVMCTRL)) {
+    // wait for any previous command
+  }
+  hri_nvmctrl_clear_INTFLAG_ERROR_bit(NVMCTRL);
+  hri_nvmctrl_clear_STATUS_PROGE_bit(NVMCTRL);
+  hri_nvmctrl_clear_STATUS_LOCKE_bit(NVMCTRL);
+  hri_nvmctrl_clear_STATUS_NVME_bit(NVMCTRL);
+
+  // ADDR takes a 16-bit word address
+  hri_nvmctrl_write_ADDR_reg(NVMCTRL, addr / 2);
+  hri_nvmctrl_write_CTRLA_reg(NVMCTRL, cmd | NVMCTRL_CTRLA_CMDEX_KEY);
+
+  while (!hri_nvmctrl_get_INTFLAG_READY_bit(NVMCTRL)) {
+    // wait for the command to finish
+  }
+  if (hri_nvmctrl_get_INTFLAG_ERROR_bit(NVMCTRL) ||
+      hri_nvmctrl_get_STATUS_PROGE_bit(NVMCTRL) ||
+      hri_nvmctrl_get_STATUS_LOCKE_bit(NVMCTRL) ||
+      hri_nvmctrl_get_STATUS_NVME_bit(NVMCTRL)) {
+    return ADXL345_ERR_WRITE;
+  }
+  return ADXL345_ERR_NONE;
+}
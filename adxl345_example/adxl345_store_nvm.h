@@ -0,0 +1,64 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _ADXL345_STORE_NVM_H_
+#define _ADXL345_STORE_NVM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdint.h>
+#include "adxl345_err.h"
+#include "adxl345_store.h"
+
+// =============================================================================
+// types and definitions
+
+/**
+ * Store backend for the SAML22: the image lives in one row of main flash,
+ * programmed through the NVMCTRL HRI.  The row must be reserved in the
+ * linker script so that code and data never land in it.
+ */
+typedef struct {
+  uint32_t row_addr;  ///< flash byte address, aligned to a row
+} adxl345_store_nvm_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Bind a flash row to an NVM backend and fill in backend.
+ */
+void adxl345_store_nvm_init(adxl345_store_nvm_t *nvm, uint32_t row_addr,
+                            adxl345_store_backend_t *backend);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_STORE_NVM_H_ */
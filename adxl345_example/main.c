@@ -27,16 +27,25 @@
 
 #include <atmel_start.h>
 #include <stdio.h>
+#include <string.h>
 #include "adxl345.h"
 #include "adxl345_asf4_i2c.h"
 #include "adxl345_err.h"
+#include "adxl345_store.h"
+#include "adxl345_store_nvm.h"
 
 // =============================================================================
 // local types and definitions
 
+// The last flash row holds the saved configuration.  saml22n18a_flash.ld
+// ends rom one row early so code and data never land in it.
+#define STORE_ROW_ADDR (FLASH_SIZE - NVMCTRL_ROW_PAGES * NVMCTRL_PAGE_SIZE)
+
 // =============================================================================
 // local (forward) declarations
 
+static void configure(adxl345_t *adxl345);
+
 // =============================================================================
 // local storage
 
@@ -49,9 +58,34 @@ static uint8_t s_high_water;
 // =============================================================================
 // local (static) code
 
+static void configure(adxl345_t *adxl345) {
+  adxl345_err_t err;
+
+  // Reset the ADXL345 (in case it was running)
+  err = adxl345_reset(adxl345);
+  ASSERT(err == ADXL345_ERR_NONE);
+
+  // Configure ADXL345 sampling rate to 100 Hz
+  err = adxl345_set_bw_rate_reg(adxl345, ADXL345_RATE_50);
+  ASSERT(err == ADXL345_ERR_NONE);
+
+  // Configure FIFO mode with high water mark set to 1 sample.
+  err = adxl345_set_fifo_ctl_reg(adxl345, ADXL345_FIFO_MODE_ENABLE | 1);
+  ASSERT(err == ADXL345_ERR_NONE);
+
+  // Start converting
+  err = adxl345_start(adxl345);
+  ASSERT(err == ADXL345_ERR_NONE);
+}
+
 int main(void) {
   adxl345_t adxl345;          // the ADXL345 object
   adxl345_dev_t adxl345_dev;  // the ADXL345 device interface
+  adxl345_store_nvm_t nvm;    // flash row holding the last good configuration
+  adxl345_store_backend_t store;
+  adxl345_store_image_t image;
+  adxl345_store_image_t saved;
+  bool warm;
   adxl345_err_t err;
 
   /* Initializes MCU, drivers and middleware */
@@ -68,27 +102,34 @@ int main(void) {
   err = adxl345_init(&adxl345, &adxl345_dev);
   // ASSERT(err == ADXL345_ERR_NONE);
 
-  // Reset the ADXL345 (in case it was running)
-  err = adxl345_reset(&adxl345);
+  // After a watchdog reset the ADXL345 is usually still running with the
+  // configuration we gave it.  If so, skip reset and configuration.
+  adxl345_store_nvm_init(&nvm, STORE_ROW_ADDR, &store);
+  err = adxl345_store_warm_boot(&adxl345, &store, &image, &warm);
   ASSERT(err == ADXL345_ERR_NONE);
 
-  // Configure ADXL345 sampling rate to 100 Hz
-  err = adxl345_set_bw_rate_reg(&adxl345, ADXL345_RATE_50);
-  ASSERT(err == ADXL345_ERR_NONE);
+  if (warm) {
+    printf("warm boot: configuration unchanged\n");
+  } else {
+    configure(&adxl345);
 
-  // Configure FIFO mode with high water mark set to 1 sample.
-  err = adxl345_set_fifo_ctl_reg(&adxl345, ADXL345_FIFO_MODE_ENABLE | 1);
-  ASSERT(err == ADXL345_ERR_NONE);
+    // remember it for next time, but only erase the flash row when the
+    // stored image is missing or differs: most cold boots (power cycles)
+    // end up with the same configuration
+    err = adxl345_store_capture(&adxl345, NULL, &image);
+    ASSERT(err == ADXL345_ERR_NONE);
+    if ((adxl345_store_load(&store, &saved) != ADXL345_ERR_NONE) ||
+        (memcmp(&saved, &image, sizeof(image)) != 0)) {
+      err = adxl345_store_save(&store, &image);
+      ASSERT(err == ADXL345_ERR_NONE);
+    }
+  }
 
   s_high_water = 0;
   s_sample_count = 0;
 
   printf("high water, sample count, x, y, z\n");
 
-  // Start converting
-  err = adxl345_start(&adxl345);
-  ASSERT(err == ADXL345_ERR_NONE);
-
   while (1) {
     uint8_t available;         // # of samples available in FIFO
     adxl345_fsample_t sample;  // xyz sample data
@@ -0,0 +1,276 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include <math.h>
+#include <string.h>
+#include "adxl345_fft.h"
+#include "adxl345.h"
+#include "adxl345_err.h"
+#include "adxl345_math.h"
+
+// =============================================================================
+// local types and definitions
+
+#define PI 3.14159265358979323846
+
+// Samples are scaled up by this shift before the transform.  With 13-bit
+// input that leaves |x| <= 2^14, so the modulus of each packed complex value
+// stays below 2^15 and no butterfly can overflow.
+#define INPUT_SHIFT 2
+
+// =============================================================================
+// local (forward) declarations
+
+static bool process_segment(adxl345_fft_t *fft);
+
+static void latch(adxl345_fft_t *fft);
+
+static void load_axis(adxl345_fft_t *fft, adxl345_fft_axis_t axis);
+
+static void complex_fft(const adxl345_fft_t *fft, int16_t *buf, uint16_t m);
+
+static int16_t axis_value(const adxl345_isample_t *s, adxl345_fft_axis_t axis);
+
+static int16_t saturate16(int32_t v);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+adxl345_err_t adxl345_fft_init(adxl345_fft_t *fft, uint16_t n, uint16_t hop,
+                               uint8_t n_average) {
+  if ((n < ADXL345_FFT_MIN_N) || (n > ADXL345_FFT_MAX_N) ||
+      ((n & (n - 1)) != 0) || (hop == 0) || (hop > n) || (n_average == 0) ||
+      (n_average > ADXL345_FFT_MAX_AVERAGE)) {
+    return ADXL345_ERR_PARAM;
+  }
+
+  fft->n = n;
+  fft->hop = hop;
+  fft->n_average = n_average;
+
+  for (uint16_t i = 0; i < n; i++) {
+    // periodic Hann, the right choice for overlapped spectral averaging
+    double w = 0.5 * (1.0 - cos(2.0 * PI * i / n));
+    fft->window[i] = (int16_t)lround(w * INT16_MAX);
+  }
+  for (uint16_t k = 0; k < n / 2; k++) {
+    fft->cos_q15[k] = (int16_t)lround(cos(2.0 * PI * k / n) * INT16_MAX);
+    fft->sin_q15[k] = (int16_t)lround(sin(2.0 * PI * k / n) * INT16_MAX);
+  }
+
+  adxl345_fft_reset(fft);
+  return ADXL345_ERR_NONE;
+}
+
+void adxl345_fft_reset(adxl345_fft_t *fft) {
+  fft->fill = 0;
+  fft->segments = 0;
+  fft->ready = false;
+  memset(fft->power, 0, sizeof(fft->power));
+}
+
+bool adxl345_fft_feed(adxl345_fft_t *fft, const adxl345_isample_t *samples,
+                      uint16_t n) {
+  bool completed = false;
+
+  for (uint16_t i = 0; i < n; i++) {
+    fft->frame[fft->fill++] = samples[i];
+    if (fft->fill < fft->n) continue;
+
+    completed |= process_segment(fft);
+
+    // keep the overlap for the next segment
+    memmove(fft->frame, &fft->frame[fft->hop],
+            (fft->n - fft->hop) * sizeof(adxl345_isample_t));
+    fft->fill = fft->n - fft->hop;
+  }
+  return completed;
+}
+
+adxl345_err_t adxl345_fft_spectrum(const adxl345_fft_t *fft,
+                                   adxl345_fft_axis_t axis, uint16_t *mag) {
+  if (!fft->ready || (axis > ADXL345_FFT_Z)) return ADXL345_ERR_PARAM;
+
+  memcpy(mag, fft->mag[axis], (fft->n / 2) * sizeof(uint16_t));
+  return ADXL345_ERR_NONE;
+}
+
+void adxl345_fft_real_q15(const adxl345_fft_t *fft, int16_t *buf) {
+  uint16_t m = fft->n / 2;
+  int32_t r0;
+  int32_t i0;
+
+  // x[2i] + j x[2i+1] is already the packed layout of buf
+  complex_fft(fft, buf, m);
+
+  // Split the n/2 point result into the spectrum of the real input:
+  //   X[k]     = (E + W^k O) / 4
+  //   X[m - k] = conj(E - W^k O) / 4
+  // with E = Z[k] + conj(Z[m-k]) and O = -j (Z[k] - conj(Z[m-k])).  The
+  // extra 1/2 keeps the result in range for any input.
+  r0 = buf[0];
+  i0 = buf[1];
+  buf[0] = (int16_t)((r0 + i0) >> 1);
+  buf[1] = (int16_t)((r0 - i0) >> 1);
+
+  for (uint16_t k = 1; k <= m / 2; k++) {
+    int16_t *zk = &buf[2 * k];
+    int16_t *zm = &buf[2 * (m - k)];
+    int32_t er = (int32_t)zk[0] + zm[0];
+    int32_t ei = (int32_t)zk[1] - zm[1];
+    int32_t or_ = (int32_t)zk[1] + zm[1];
+    int32_t oi = (int32_t)zm[0] - zk[0];
+    int32_t c = fft->cos_q15[k];
+    int32_t s = fft->sin_q15[k];
+    int32_t tr = (int32_t)(((int64_t)c * or_ + (int64_t)s * oi) >> 15);
+    int32_t ti = (int32_t)(((int64_t)c * oi - (int64_t)s * or_) >> 15);
+
+    zk[0] = saturate16((er + tr) >> 2);
+    zk[1] = saturate16((ei + ti) >> 2);
+    zm[0] = saturate16((er - tr) >> 2);
+    zm[1] = saturate16(-(ei - ti) >> 2);
+  }
+}
+
+// =============================================================================
+// local (static) code
+
+static bool process_segment(adxl345_fft_t *fft) {
+  uint16_t half = fft->n / 2;
+
+  for (uint8_t a = ADXL345_FFT_X; a <= ADXL345_FFT_Z; a++) {
+    uint32_t *power = fft->power[a];
+
+    load_axis(fft, (adxl345_fft_axis_t)a);
+    adxl345_fft_real_q15(fft, fft->work);
+
+    // bin 0 is DC (removed); its imaginary slot holds Nyquist, not used
+    for (uint16_t k = 1; k < half; k++) {
+      int32_t re = fft->work[2 * k];
+      int32_t im = fft->work[2 * k + 1];
+      uint32_t p = (uint32_t)(re * re) + (uint32_t)(im * im);
+      power[k] = (power[k] > UINT32_MAX - p) ? UINT32_MAX : power[k] + p;
+    }
+  }
+
+  if (++fft->segments < fft->n_average) return false;
+  latch(fft);
+  return true;
+}
+
+static void latch(adxl345_fft_t *fft) {
+  uint64_t scale = ADXL345_FFT_AMPLITUDE_SCALE * ADXL345_FFT_AMPLITUDE_SCALE;
+
+  // copy out the magnitudes so the next average cannot overwrite them
+  // before the caller reads them
+  for (uint8_t a = ADXL345_FFT_X; a <= ADXL345_FFT_Z; a++) {
+    for (uint16_t k = 0; k < fft->n / 2; k++) {
+      uint32_t m = adxl345_isqrt64(fft->power[a][k] * scale / fft->segments);
+      fft->mag[a][k] = (m > UINT16_MAX) ? UINT16_MAX : (uint16_t)m;
+    }
+  }
+  memset(fft->power, 0, sizeof(fft->power));
+  fft->segments = 0;
+  fft->ready = true;
+}
+
+static void load_axis(adxl345_fft_t *fft, adxl345_fft_axis_t axis) {
+  int16_t *work = fft->work;
+  int32_t sum = 0;
+  int32_t mean;
+
+  for (uint16_t i = 0; i < fft->n; i++) {
+    sum += axis_value(&fft->frame[i], axis);
+  }
+  mean = sum / fft->n;
+
+  for (uint16_t i = 0; i < fft->n; i++) {
+    int32_t v = (axis_value(&fft->frame[i], axis) - mean) * fft->window[i];
+    work[i] = saturate16(v >> (15 - INPUT_SHIFT));
+  }
+}
+
+static void complex_fft(const adxl345_fft_t *fft, int16_t *buf, uint16_t m) {
+  uint16_t n = fft->n;
+
+  // bit-reverse reorder
+  for (uint16_t i = 1, j = 0; i < m; i++) {
+    uint16_t bit = m >> 1;
+    for (; j & bit; bit >>= 1) j ^= bit;
+    j ^= bit;
+    if (i < j) {
+      int16_t t = buf[2 * i];
+      buf[2 * i] = buf[2 * j];
+      buf[2 * j] = t;
+      t = buf[2 * i + 1];
+      buf[2 * i + 1] = buf[2 * j + 1];
+      buf[2 * j + 1] = t;
+    }
+  }
+
+  // radix-2 decimation in time, scaled by 1/2 per stage
+  for (uint16_t len = 2; len <= m; len <<= 1) {
+    uint16_t half = len >> 1;
+    uint16_t step = n / len;
+    for (uint16_t i = 0; i < m; i += len) {
+      for (uint16_t j = 0; j < half; j++) {
+        int16_t *a = &buf[2 * (i + j)];
+        int16_t *b = &buf[2 * (i + j + half)];
+        int32_t wr = fft->cos_q15[j * step];
+        int32_t wi = -fft->sin_q15[j * step];
+        int32_t tr = (b[0] * wr - b[1] * wi + (1 << 14)) >> 15;
+        int32_t ti = (b[0] * wi + b[1] * wr + (1 << 14)) >> 15;
+        int32_t ar = a[0];
+        int32_t ai = a[1];
+        a[0] = (int16_t)((ar + tr) >> 1);
+        a[1] = (int16_t)((ai + ti) >> 1);
+        b[0] = (int16_t)((ar - tr) >> 1);
+        b[1] = (int16_t)((ai - ti) >> 1);
+      }
+    }
+  }
+}
+
+static int16_t axis_value(const adxl345_isample_t *s, adxl345_fft_axis_t axis) {
+  switch (axis) {
+  case ADXL345_FFT_X:
+    return s->x;
+  case ADXL345_FFT_Y:
+    return s->y;
+  default:
+    return s->z;
+  }
+}
+
+static int16_t saturate16(int32_t v) {
+  if (v > INT16_MAX) return INT16_MAX;
+  if (v < INT16_MIN) return INT16_MIN;
+  return (int16_t)v;
+}
@@ -0,0 +1,142 @@
+/** @file adxl345_fft.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_FFT_H_
+#define _ADXL345_FFT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// types and definitions
+
+/** Largest transform length; sets the size of adxl345_fft_t. */
+#ifndef ADXL345_FFT_MAX_N
+#define ADXL345_FFT_MAX_N 256
+#endif
+
+#define ADXL345_FFT_MIN_N 16
+
+/** Most segments that may be averaged into one spectrum. */
+#define ADXL345_FFT_MAX_AVERAGE 32
+
+/**
+ * Spectrum bins hold peak amplitude in units of 1/ADXL345_FFT_AMPLITUDE_SCALE
+ * LSB: a sine of amplitude A LSB centred on a bin reads A * 4 there.
+ */
+#define ADXL345_FFT_AMPLITUDE_SCALE 4
+
+typedef enum {
+  ADXL345_FFT_X,
+  ADXL345_FFT_Y,
+  ADXL345_FFT_Z,
+} adxl345_fft_axis_t;
+
+/**
+ * Welch spectrum engine.
+ *
+ * Samples are collected into segments of n, which overlap by n - hop.  Each
+ * segment has its mean removed, is Hann windowed and goes through a Q15 real
+ * FFT (an n/2 point complex FFT plus a split pass, scaled by 1/2 per stage so
+ * it cannot overflow).  Power is averaged over n_average segments per axis,
+ * after which the n/2 bin magnitudes are latched for reading while the next
+ * average starts.
+ *
+ * Bin k is centred on k * ODR / n.
+ */
+typedef struct {
+  uint16_t n;                ///< transform length
+  uint16_t hop;              ///< new samples per segment
+  uint8_t n_average;         ///< segments per spectrum
+  uint8_t segments;          ///< segments in the current average
+  bool ready;                ///< mag holds a complete spectrum
+  uint16_t fill;             ///< samples in frame
+  adxl345_isample_t frame[ADXL345_FFT_MAX_N];
+  int16_t work[ADXL345_FFT_MAX_N];          ///< n/2 complex, interleaved
+  int16_t window[ADXL345_FFT_MAX_N];        ///< Q15 Hann
+  int16_t cos_q15[ADXL345_FFT_MAX_N / 2];   ///< cos(2 pi k / n)
+  int16_t sin_q15[ADXL345_FFT_MAX_N / 2];   ///< sin(2 pi k / n)
+  uint32_t power[3][ADXL345_FFT_MAX_N / 2]; ///< summed |X[k]|^2
+  uint16_t mag[3][ADXL345_FFT_MAX_N / 2];   ///< last complete spectrum
+} adxl345_fft_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Set up an n point engine averaging n_average segments.
+ *
+ * n must be a power of two from ADXL345_FFT_MIN_N to ADXL345_FFT_MAX_N and
+ * hop from 1 to n (n / 2 gives the usual 50% overlap).  Computes the window
+ * and twiddle tables.
+ */
+adxl345_err_t adxl345_fft_init(adxl345_fft_t *fft, uint16_t n, uint16_t hop,
+                               uint8_t n_average);
+
+/**
+ * @brief Drop collected samples and the partial average.
+ */
+void adxl345_fft_reset(adxl345_fft_t *fft);
+
+/**
+ * @brief Add samples, transforming each segment as it completes.
+ *
+ * Returns true if a spectrum completed during this call.  It stays readable
+ * until the next spectrum completes, however many segments follow in the
+ * same call; if several complete, the last one is kept.
+ */
+bool adxl345_fft_feed(adxl345_fft_t *fft, const adxl345_isample_t *samples,
+                      uint16_t n);
+
+/**
+ * @brief Read the n/2 bin magnitudes of the last complete spectrum.
+ *
+ * Returns ADXL345_ERR_PARAM if none is available yet.
+ */
+adxl345_err_t adxl345_fft_spectrum(const adxl345_fft_t *fft,
+                                   adxl345_fft_axis_t axis, uint16_t *mag);
+
+/**
+ * @brief In-place Q15 real FFT of fft->n samples in buf.
+ *
+ * On return buf holds bins 0 .. n/2 - 1 as interleaved re, im pairs, scaled
+ * by 1/n.  The imaginary slot of bin 0 holds the Nyquist bin's real part.
+ */
+void adxl345_fft_real_q15(const adxl345_fft_t *fft, int16_t *buf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_FFT_H_ */
@@ -0,0 +1,205 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include <math.h>
+#include <string.h>
+#include "adxl345_goertzel.h"
+#include "adxl345.h"
+#include "adxl345_err.h"
+#include "adxl345_math.h"
+
+// =============================================================================
+// local types and definitions
+
+#define PI 3.14159265358979323846
+
+// Q30 keeps the resonance within a few uHz of the tone at any ODR; Q14 was
+// off by more than 0.5 Hz at 3200 Hz
+#define COEF_FRAC_BITS 30
+
+// =============================================================================
+// local (forward) declarations
+
+static adxl345_err_t tune(uint32_t freq_mhz, uint32_t odr_mhz,
+                         int32_t *coef);
+
+static void clear(adxl345_goertzel_tone_t *tone);
+
+static void step(int32_t coef, int32_t *s1, int32_t *s2, int16_t x);
+
+static uint16_t amplitude(int32_t coef, int32_t s1, int32_t s2,
+                          uint16_t window);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+adxl345_err_t adxl345_goertzel_init(adxl345_goertzel_t *g, uint16_t window,
+                                    uint32_t odr_mhz) {
+  if ((window < ADXL345_GOERTZEL_MIN_WINDOW) ||
+      (window > ADXL345_GOERTZEL_MAX_WINDOW) || (odr_mhz == 0)) {
+    return ADXL345_ERR_PARAM;
+  }
+  memset(g->tones, 0, sizeof(g->tones));
+  g->n_tones = 0;
+  g->window = window;
+  g->count = 0;
+  g->odr_mhz = odr_mhz;
+  g->windows = 0;
+  return ADXL345_ERR_NONE;
+}
+
+adxl345_err_t adxl345_goertzel_add(adxl345_goertzel_t *g, uint32_t freq_mhz) {
+  if (g->n_tones >= ADXL345_GOERTZEL_MAX_TONES) return ADXL345_ERR_PARAM;
+  g->n_tones += 1;
+  if (adxl345_goertzel_set(g, g->n_tones - 1, freq_mhz) != ADXL345_ERR_NONE) {
+    g->n_tones -= 1;
+    return ADXL345_ERR_PARAM;
+  }
+  return ADXL345_ERR_NONE;
+}
+
+adxl345_err_t adxl345_goertzel_set(adxl345_goertzel_t *g, uint8_t index,
+                                   uint32_t freq_mhz) {
+  adxl345_goertzel_tone_t *tone = &g->tones[index];
+  int32_t coef;
+
+  if ((index >= g->n_tones) || (freq_mhz >= g->odr_mhz / 2)) {
+    return ADXL345_ERR_PARAM;
+  }
+  if (tune(freq_mhz, g->odr_mhz, &coef) != ADXL345_ERR_NONE) {
+    return ADXL345_ERR_PARAM;
+  }
+  tone->freq_mhz = freq_mhz;
+  tone->coef = coef;
+
+  // restart the window so no result mixes two frequencies or is short
+  g->count = 0;
+  for (uint8_t i = 0; i < g->n_tones; i++) clear(&g->tones[i]);
+  return ADXL345_ERR_NONE;
+}
+
+adxl345_err_t adxl345_goertzel_set_odr(adxl345_goertzel_t *g,
+                                       uint32_t odr_mhz) {
+  int32_t coefs[ADXL345_GOERTZEL_MAX_TONES];
+
+  if (odr_mhz == 0) return ADXL345_ERR_PARAM;
+  // retune nothing unless every tone is still valid at the new rate
+  for (uint8_t i = 0; i < g->n_tones; i++) {
+    if ((g->tones[i].freq_mhz >= odr_mhz / 2) ||
+        (tune(g->tones[i].freq_mhz, odr_mhz, &coefs[i]) != ADXL345_ERR_NONE)) {
+      return ADXL345_ERR_PARAM;
+    }
+  }
+  g->odr_mhz = odr_mhz;
+  g->count = 0;
+  for (uint8_t i = 0; i < g->n_tones; i++) {
+    g->tones[i].coef = coefs[i];
+    clear(&g->tones[i]);
+  }
+  return ADXL345_ERR_NONE;
+}
+
+bool adxl345_goertzel_feed(adxl345_goertzel_t *g,
+                           const adxl345_isample_t *samples, uint16_t n) {
+  bool completed = false;
+
+  while (n > 0) {
+    uint16_t chunk = g->window - g->count;
+    if (chunk > n) chunk = n;
+
+    // tone-major over the chunk keeps one tone's state in registers
+    for (uint8_t t = 0; t < g->n_tones; t++) {
+      adxl345_goertzel_tone_t *tone = &g->tones[t];
+      int32_t coef = tone->coef;
+      for (uint16_t i = 0; i < chunk; i++) {
+        step(coef, &tone->s1[0], &tone->s2[0], samples[i].x);
+        step(coef, &tone->s1[1], &tone->s2[1], samples[i].y);
+        step(coef, &tone->s1[2], &tone->s2[2], samples[i].z);
+      }
+    }
+    samples += chunk;
+    n -= chunk;
+    g->count += chunk;
+
+    if (g->count < g->window) break;
+    for (uint8_t t = 0; t < g->n_tones; t++) {
+      adxl345_goertzel_tone_t *tone = &g->tones[t];
+      for (uint8_t a = 0; a < 3; a++) {
+        tone->amplitude[a] =
+            amplitude(tone->coef, tone->s1[a], tone->s2[a], g->window);
+      }
+      clear(tone);
+    }
+    g->count = 0;
+    g->windows += 1;
+    completed = true;
+  }
+  return completed;
+}
+
+// =============================================================================
+// local (static) code
+
+static adxl345_err_t tune(uint32_t freq_mhz, uint32_t odr_mhz,
+                         int32_t *coef) {
+  double w = 2.0 * PI * freq_mhz / odr_mhz;
+  double c = nearbyint(2.0 * cos(w) * (double)(1L << COEF_FRAC_BITS));
+  double limit = 2.0 * (double)(1L << COEF_FRAC_BITS);
+
+  // a coefficient of +/-2 is a resonator at DC or Nyquist whose state grows
+  // without bound; it also would not fit in Q30
+  if ((c >= limit) || (c <= -limit)) return ADXL345_ERR_PARAM;
+  *coef = (int32_t)c;
+  return ADXL345_ERR_NONE;
+}
+
+static void clear(adxl345_goertzel_tone_t *tone) {
+  memset(tone->s1, 0, sizeof(tone->s1));
+  memset(tone->s2, 0, sizeof(tone->s2));
+}
+
+static void step(int32_t coef, int32_t *s1, int32_t *s2, int16_t x) {
+  // |s| grows to about window * |x| / sin(w), past 32 bits for the product
+  int32_t s = x + (int32_t)(((int64_t)coef * *s1) >> COEF_FRAC_BITS) - *s2;
+  *s2 = *s1;
+  *s1 = s;
+}
+
+static uint16_t amplitude(int32_t coef, int32_t s1, int32_t s2,
+                          uint16_t window) {
+  // |X|^2 = s1^2 + s2^2 - coef s1 s2, and a sine of amplitude A gives
+  // |X| = A * window / 2
+  int64_t p = (int64_t)s1 * s1 + (int64_t)s2 * s2 -
+              (((int64_t)coef * s1) >> COEF_FRAC_BITS) * s2;
+  uint32_t mag = adxl345_isqrt64(p < 0 ? 0 : (uint64_t)p);
+  uint64_t a =
+      ((uint64_t)mag * 2 * ADXL345_GOERTZEL_AMPLITUDE_SCALE) / window;
+  return (a > UINT16_MAX) ? UINT16_MAX : (uint16_t)a;
+}
@@ -0,0 +1,122 @@
+/** @file adxl345_goertzel.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_GOERTZEL_H_
+#define _ADXL345_GOERTZEL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// types and definitions
+
+#define ADXL345_GOERTZEL_MAX_TONES 8
+#define ADXL345_GOERTZEL_MIN_WINDOW 8
+#define ADXL345_GOERTZEL_MAX_WINDOW 4096
+
+/**
+ * Amplitudes are in units of 1/ADXL345_GOERTZEL_AMPLITUDE_SCALE LSB: a sine
+ * of amplitude A LSB on a tone reads A * 16.
+ */
+#define ADXL345_GOERTZEL_AMPLITUDE_SCALE 16
+
+typedef struct {
+  uint32_t freq_mhz;  ///< tone frequency in millihertz
+  int32_t coef;       ///< 2 cos(2 pi f / ODR), Q30
+  int32_t s1[3];      ///< per-axis state
+  int32_t s2[3];
+  uint16_t amplitude[3];  ///< per-axis result of the last window
+} adxl345_goertzel_tone_t;
+
+/**
+ * Goertzel filter bank.
+ *
+ * Each tone costs one multiply per sample per axis, so a handful of tones is
+ * much cheaper than a full spectrum.  Samples are consumed as they arrive,
+ * in whatever batch sizes the FIFO delivers; every `window` samples the
+ * amplitudes are latched and the filters restart.  Frequency resolution is
+ * ODR / window, and tones need not fall on a bin centre.
+ *
+ * Frequencies are kept in millihertz and the coefficients are recomputed
+ * when the ODR changes, e.g. on an adxl345_burst marker.
+ */
+typedef struct {
+  adxl345_goertzel_tone_t tones[ADXL345_GOERTZEL_MAX_TONES];
+  uint8_t n_tones;
+  uint16_t window;  ///< samples per result
+  uint16_t count;   ///< samples in the current window
+  uint32_t odr_mhz;
+  uint32_t windows; ///< results produced
+} adxl345_goertzel_t;
+
+// =============================================================================
+// declarations
+
+adxl345_err_t adxl345_goertzel_init(adxl345_goertzel_t *g, uint16_t window,
+                                    uint32_t odr_mhz);
+
+/**
+ * @brief Add a tone and restart the window.  Returns ADXL345_ERR_PARAM if
+ * the bank is full, the frequency is not below ODR / 2, or it is so close to
+ * DC or ODR / 2 that the coefficient rounds to +/-2.
+ */
+adxl345_err_t adxl345_goertzel_add(adxl345_goertzel_t *g, uint32_t freq_mhz);
+
+/**
+ * @brief Retune an existing tone, e.g. to follow shaft speed.  The window
+ * restarts for every tone.
+ */
+adxl345_err_t adxl345_goertzel_set(adxl345_goertzel_t *g, uint8_t index,
+                                   uint32_t freq_mhz);
+
+/**
+ * @brief Recompute all coefficients for a new ODR and restart the window.
+ */
+adxl345_err_t adxl345_goertzel_set_odr(adxl345_goertzel_t *g,
+                                       uint32_t odr_mhz);
+
+/**
+ * @brief Run the bank over n samples.
+ *
+ * Returns true if a window completed during this call; its amplitudes stay
+ * in tones[i].amplitude until the next one completes.
+ */
+bool adxl345_goertzel_feed(adxl345_goertzel_t *g,
+                           const adxl345_isample_t *samples, uint16_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_GOERTZEL_H_ */
@@ -0,0 +1,81 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include "adxl345_math.h"
+
+// =============================================================================
+// local types and definitions
+
+// =============================================================================
+// local (forward) declarations
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+uint16_t adxl345_isqrt32(uint32_t v) {
+  uint32_t root = 0;
+  uint32_t bit = 1UL << 30;
+
+  while (bit > v) bit >>= 2;
+  while (bit != 0) {
+    if (v >= root + bit) {
+      v -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint16_t)root;
+}
+
+uint32_t adxl345_isqrt64(uint64_t v) {
+  uint64_t root = 0;
+  uint64_t bit = 1ULL << 62;
+
+  if (v <= UINT32_MAX) return adxl345_isqrt32((uint32_t)v);
+  while (bit > v) bit >>= 2;
+  while (bit != 0) {
+    if (v >= root + bit) {
+      v -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint32_t)root;
+}
+
+int16_t adxl345_mul_q15(int16_t a, int16_t b) {
+  int32_t p = ((int32_t)a * b + (1 << 14)) >> 15;
+  // only -1.0 * -1.0 can overflow
+  return (p > INT16_MAX) ? INT16_MAX : (int16_t)p;
+}
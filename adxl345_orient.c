@@ -0,0 +1,205 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include <math.h>
+#include "adxl345_orient.h"
+#include "adxl345.h"
+#include "adxl345_err.h"
+#include "adxl345_math.h"
+
+// =============================================================================
+// local types and definitions
+
+#define PI 3.14159265358979323846
+
+#define CORDIC_STEPS 27
+
+// angles are carried as degrees in Q20
+#define ANGLE_FRAC_BITS 20
+#define DEG_Q20(d) ((int32_t)(d) * (1L << ANGLE_FRAC_BITS))
+
+// inputs are normalised to just under this so the CORDIC gain (1.647) and
+// the sqrt(2) of the first step cannot overflow 32 bits
+#define CORDIC_TOP (1L << 28)
+
+#define MAX_HYSTERESIS_DEG 40
+
+// =============================================================================
+// local (forward) declarations
+
+static adxl345_face_t dominant(int32_t x, int32_t y, int32_t z, int32_t *mag);
+
+static int32_t face_component(adxl345_face_t face, int32_t x, int32_t y,
+                              int32_t z);
+
+// =============================================================================
+// local storage
+
+// atan(2^-i) in degrees, Q20
+static const int32_t s_atan_q20[CORDIC_STEPS] = {
+    47185920, 27855475, 14718068, 7471121, 3750058, 1876857, 938658,
+    469357,   234682,   117342,   58671,   29335,   14668,   7334,
+    3667,     1833,     917,      458,     229,     115,     57,
+    29,       14,       7,        4,       2,       1};
+
+// =============================================================================
+// public code
+
+int16_t adxl345_orient_atan2(int32_t y, int32_t x) {
+  int32_t z = 0;
+  int32_t t;
+
+  if ((x == 0) && (y == 0)) return 0;
+
+  // scale up for resolution; the angle does not depend on magnitude
+  while ((x < CORDIC_TOP / 2) && (x > -CORDIC_TOP / 2) &&
+         (y < CORDIC_TOP / 2) && (y > -CORDIC_TOP / 2)) {
+    x *= 2;
+    y *= 2;
+  }
+
+  // rotate into the right half plane, where the iteration converges
+  if (x < 0) {
+    t = x;
+    if (y >= 0) {
+      x = y;
+      y = -t;
+      z = DEG_Q20(90);
+    } else {
+      x = -y;
+      y = t;
+      z = DEG_Q20(-90);
+    }
+  }
+
+  for (uint8_t i = 0; i < CORDIC_STEPS; i++) {
+    t = x;
+    if (y > 0) {
+      x += y >> i;
+      y -= t >> i;
+      z += s_atan_q20[i];
+    } else {
+      x -= y >> i;
+      y += t >> i;
+      z -= s_atan_q20[i];
+    }
+  }
+
+  // Q20 degrees to centidegrees, rounded
+  t = (int32_t)(((int64_t)z * 100 + (1L << (ANGLE_FRAC_BITS - 1))) >>
+                ANGLE_FRAC_BITS);
+  return (int16_t)t;
+}
+
+adxl345_err_t adxl345_orient_init(adxl345_orient_state_t *st,
+                                  uint8_t hysteresis_deg) {
+  if (hysteresis_deg > MAX_HYSTERESIS_DEG) return ADXL345_ERR_PARAM;
+  st->current.pitch_cdeg = 0;
+  st->current.roll_cdeg = 0;
+  st->current.face = ADXL345_FACE_UNKNOWN;
+  st->switch_q10 =
+      (int32_t)lround(tan((45.0 + hysteresis_deg) * PI / 180.0) * 1024.0);
+  return ADXL345_ERR_NONE;
+}
+
+void adxl345_orient_update(adxl345_orient_state_t *st,
+                           const adxl345_isample_t *samples, uint16_t n,
+                           adxl345_orient_t *out) {
+  int32_t sx = 0, sy = 0, sz = 0;
+  int32_t x, y, z, mag, cur;
+  adxl345_face_t face;
+
+  if (n == 0) {
+    *out = st->current;
+    return;
+  }
+
+  for (uint16_t i = 0; i < n; i++) {
+    sx += samples[i].x;
+    sy += samples[i].y;
+    sz += samples[i].z;
+  }
+  x = sx / n;
+  y = sy / n;
+  z = sz / n;
+
+  st->current.roll_cdeg = adxl345_orient_atan2(y, z);
+  st->current.pitch_cdeg = adxl345_orient_atan2(
+      -x, adxl345_isqrt32((uint32_t)(y * y) + (uint32_t)(z * z)));
+
+  face = dominant(x, y, z, &mag);
+  if (st->current.face == ADXL345_FACE_UNKNOWN) {
+    st->current.face = face;
+  } else if (face != st->current.face) {
+    // leave the old face only once the new axis clearly dominates it
+    cur = face_component(st->current.face, x, y, z);
+    if ((int64_t)mag * 1024 > (int64_t)cur * st->switch_q10) {
+      st->current.face = face;
+    }
+  }
+  *out = st->current;
+}
+
+// =============================================================================
+// local (static) code
+
+static adxl345_face_t dominant(int32_t x, int32_t y, int32_t z, int32_t *mag) {
+  int32_t ax = (x < 0) ? -x : x;
+  int32_t ay = (y < 0) ? -y : y;
+  int32_t az = (z < 0) ? -z : z;
+
+  if ((ax >= ay) && (ax >= az)) {
+    *mag = ax;
+    return (x >= 0) ? ADXL345_FACE_X_UP : ADXL345_FACE_X_DOWN;
+  } else if (ay >= az) {
+    *mag = ay;
+    return (y >= 0) ? ADXL345_FACE_Y_UP : ADXL345_FACE_Y_DOWN;
+  }
+  *mag = az;
+  return (z >= 0) ? ADXL345_FACE_Z_UP : ADXL345_FACE_Z_DOWN;
+}
+
+static int32_t face_component(adxl345_face_t face, int32_t x, int32_t y,
+                              int32_t z) {
+  // gravity along the face's own direction; negative if it has flipped over
+  switch (face) {
+  case ADXL345_FACE_X_UP:
+    return x;
+  case ADXL345_FACE_X_DOWN:
+    return -x;
+  case ADXL345_FACE_Y_UP:
+    return y;
+  case ADXL345_FACE_Y_DOWN:
+    return -y;
+  case ADXL345_FACE_Z_UP:
+    return z;
+  case ADXL345_FACE_Z_DOWN:
+    return -z;
+  default:
+    return 0;
+  }
+}
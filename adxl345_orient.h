@@ -0,0 +1,110 @@
+/** @file adxl345_orient.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_ORIENT_H_
+#define _ADXL345_ORIENT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdint.h>
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// types and definitions
+
+typedef enum {
+  ADXL345_FACE_UNKNOWN,
+  ADXL345_FACE_X_UP,
+  ADXL345_FACE_X_DOWN,
+  ADXL345_FACE_Y_UP,
+  ADXL345_FACE_Y_DOWN,
+  ADXL345_FACE_Z_UP,
+  ADXL345_FACE_Z_DOWN,
+} adxl345_face_t;
+
+typedef struct {
+  int16_t pitch_cdeg;   ///< rotation about Y, -9000 .. 9000 centidegrees
+  int16_t roll_cdeg;    ///< rotation about X, -18000 .. 18000 centidegrees
+  adxl345_face_t face;  ///< axis pointing up, with hysteresis
+} adxl345_orient_t;
+
+/**
+ * Orientation from the gravity vector.
+ *
+ * Each update averages a batch and does one pitch / roll / face solution,
+ * so the cost is per batch, not per sample, and the averaging doubles as
+ * the low-pass.  The angles use an integer CORDIC with no multiplies in
+ * the loop, which avoids soft-float atan2f() on parts without an FPU.
+ *
+ * The face only changes when the new axis' share of gravity exceeds the
+ * old one's by the hysteresis angle, so a part resting near 45 degrees does
+ * not chatter.
+ */
+typedef struct {
+  adxl345_orient_t current;
+  int32_t switch_q10;  ///< tan(45 + hysteresis), Q10
+} adxl345_orient_state_t;
+
+/**
+ * Bound on |adxl345_orient_atan2() - atan2()| in centidegrees.  Measured
+ * against libm over a 3 LSB grid of the +/-4096 square: the worst case was
+ * 0.50, i.e. the result is the correctly rounded value or its neighbour.
+ */
+#define ADXL345_ORIENT_MAX_ERROR_CDEG 1
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief atan2(y, x) in centidegrees, -18000 .. 18000, by CORDIC.
+ */
+int16_t adxl345_orient_atan2(int32_t y, int32_t x);
+
+/**
+ * @brief Start with no face; hysteresis_deg is 0 - 40 degrees.
+ */
+adxl345_err_t adxl345_orient_init(adxl345_orient_state_t *st,
+                                  uint8_t hysteresis_deg);
+
+/**
+ * @brief Solve orientation from the mean of n samples.
+ *
+ * Leaves the state untouched when n is 0.
+ */
+void adxl345_orient_update(adxl345_orient_state_t *st,
+                           const adxl345_isample_t *samples, uint16_t n,
+                           adxl345_orient_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_ORIENT_H_ */
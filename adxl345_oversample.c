@@ -0,0 +1,148 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include "adxl345_oversample.h"
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// local types and definitions
+
+// FIFO depth in entries
+#define FIFO_DEPTH 32
+
+// =============================================================================
+// local (forward) declarations
+
+static int32_t average(int32_t sum, uint16_t ratio);
+
+static void reset_sums(adxl345_oversample_t *os);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+adxl345_err_t adxl345_oversample_init(adxl345_oversample_t *os,
+                                      adxl345_t *adxl345, uint16_t ratio) {
+  if ((ratio == 0) || (ratio > ADXL345_OVERSAMPLE_MAX_RATIO)) {
+    return ADXL345_ERR_PARAM;
+  }
+  os->adxl345 = adxl345;
+  os->ratio = ratio;
+  reset_sums(os);
+  return ADXL345_ERR_NONE;
+}
+
+adxl345_err_t adxl345_oversample_start(adxl345_oversample_t *os,
+                                       adxl345_bw_rate_reg rate,
+                                       uint8_t watermark) {
+  adxl345_err_t err;
+
+  if (watermark > ADXL345_TRIGGER_WATERMARK_MASK) return ADXL345_ERR_PARAM;
+
+  err = adxl345_write_reg(os->adxl345, ADXL345_REG_FIFO_CTL,
+                          ADXL345_FIFO_MODE_BYPASS, false);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  err = adxl345_update_reg(os->adxl345, ADXL345_REG_BW_RATE, 0x0F, rate);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  err = adxl345_write_reg(os->adxl345, ADXL345_REG_FIFO_CTL,
+                          ADXL345_FIFO_MODE_STREAM | watermark, true);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  reset_sums(os);
+  return ADXL345_ERR_NONE;
+}
+
+uint16_t adxl345_oversample_outputs(const adxl345_oversample_t *os,
+                                    uint16_t n) {
+  return (uint16_t)(((uint32_t)os->count + n) / os->ratio);
+}
+
+uint16_t adxl345_oversample_process(adxl345_oversample_t *os,
+                                    const adxl345_isample_t *samples,
+                                    uint16_t n, adxl345_osample_t *out) {
+  uint16_t n_out = 0;
+
+  for (uint16_t i = 0; i < n; i++) {
+    os->sum_x += samples[i].x;
+    os->sum_y += samples[i].y;
+    os->sum_z += samples[i].z;
+    if (++os->count < os->ratio) continue;
+
+    out[n_out].x = average(os->sum_x, os->ratio);
+    out[n_out].y = average(os->sum_y, os->ratio);
+    out[n_out].z = average(os->sum_z, os->ratio);
+    n_out += 1;
+    reset_sums(os);
+  }
+  return n_out;
+}
+
+adxl345_err_t adxl345_oversample_service(adxl345_oversample_t *os,
+                                         adxl345_osample_t *out,
+                                         uint16_t capacity, uint16_t *n_out) {
+  adxl345_isample_t batch[FIFO_DEPTH];
+  // input that completes at most `capacity` outputs; negative when there is
+  // no room for even the pending average
+  int32_t room = (int32_t)capacity * os->ratio - os->count;
+  uint8_t entries;
+  adxl345_err_t err;
+
+  *n_out = 0;
+  if (room <= 0) return ADXL345_ERR_NONE;
+  err = adxl345_available_samples(os->adxl345, &entries);
+  if (err != ADXL345_ERR_NONE) return err;
+  if (entries > FIFO_DEPTH) entries = FIFO_DEPTH;
+  if (entries > room) entries = (uint8_t)room;
+
+  err = adxl345_get_isamples(os->adxl345, batch, entries);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  *n_out = adxl345_oversample_process(os, batch, entries, out);
+  return ADXL345_ERR_NONE;
+}
+
+// =============================================================================
+// local (static) code
+
+static int32_t average(int32_t sum, uint16_t ratio) {
+  // at the larger ratios the shifted sum no longer fits in 32 bits
+  int64_t scaled = (int64_t)sum << ADXL345_OVERSAMPLE_FRAC_BITS;
+  int64_t half = ratio / 2;
+  return (int32_t)((scaled + (scaled < 0 ? -half : half)) / ratio);
+}
+
+static void reset_sums(adxl345_oversample_t *os) {
+  os->count = 0;
+  os->sum_x = 0;
+  os->sum_y = 0;
+  os->sum_z = 0;
+}
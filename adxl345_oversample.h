@@ -0,0 +1,122 @@
+/** @file adxl345_oversample.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_OVERSAMPLE_H_
+#define _ADXL345_OVERSAMPLE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdint.h>
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// types and definitions
+
+/** Fractional bits in an adxl345_osample_t. */
+#define ADXL345_OVERSAMPLE_FRAC_BITS 8
+
+/** Largest supported decimation ratio. */
+#define ADXL345_OVERSAMPLE_MAX_RATIO 4096
+
+/**
+ * An averaged sample in raw LSB with ADXL345_OVERSAMPLE_FRAC_BITS fractional
+ * bits, i.e. value / 256 gives LSB of the DATA_FORMAT in use.
+ */
+typedef struct {
+  int32_t x;
+  int32_t y;
+  int32_t z;
+} adxl345_osample_t;
+
+/**
+ * Oversample-and-average.
+ *
+ * Runs the part at a high ODR and emits the mean of every `ratio` samples.
+ * With white noise the noise floor drops by sqrt(ratio), so averaging 64
+ * samples at 3200 Hz into 50 Hz gains about three bits; the fractional bits
+ * keep them.  Partial averages carry over between batches.
+ */
+typedef struct {
+  adxl345_t *adxl345;
+  uint16_t ratio;   ///< input samples per output sample
+  uint16_t count;   ///< input samples in the current average
+  int32_t sum_x;
+  int32_t sum_y;
+  int32_t sum_z;
+} adxl345_oversample_t;
+
+// =============================================================================
+// declarations
+
+adxl345_err_t adxl345_oversample_init(adxl345_oversample_t *os,
+                                      adxl345_t *adxl345, uint16_t ratio);
+
+/**
+ * @brief Program BW_RATE and put the FIFO in stream mode with the given
+ * watermark, discarding any partial average.
+ *
+ * The output rate is the ODR of `rate` divided by the ratio.
+ */
+adxl345_err_t adxl345_oversample_start(adxl345_oversample_t *os,
+                                       adxl345_bw_rate_reg rate,
+                                       uint8_t watermark);
+
+/**
+ * @brief Number of averages that n more input samples will complete.
+ */
+uint16_t adxl345_oversample_outputs(const adxl345_oversample_t *os,
+                                    uint16_t n);
+
+/**
+ * @brief Accumulate n raw samples, writing completed averages to out.
+ *
+ * out must have room for adxl345_oversample_outputs(os, n) entries.  Returns
+ * the number of averages written.
+ */
+uint16_t adxl345_oversample_process(adxl345_oversample_t *os,
+                                    const adxl345_isample_t *samples,
+                                    uint16_t n, adxl345_osample_t *out);
+
+/**
+ * @brief Drain the FIFO and emit any completed averages.
+ *
+ * Only drains as many entries as can complete at most capacity averages;
+ * the rest stay in the FIFO for the next call.
+ */
+adxl345_err_t adxl345_oversample_service(adxl345_oversample_t *os,
+                                         adxl345_osample_t *out,
+                                         uint16_t capacity, uint16_t *n_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_OVERSAMPLE_H_ */
@@ -0,0 +1,145 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include <stddef.h>
+#include "adxl345_pingpong.h"
+#include "adxl345.h"
+#include "adxl345_atomic.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// local types and definitions
+
+// =============================================================================
+// local (forward) declarations
+
+static void complete_block(adxl345_pingpong_t *pp);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+adxl345_err_t adxl345_pingpong_init(adxl345_pingpong_t *pp,
+                                    adxl345_isample_t *block_a,
+                                    adxl345_isample_t *block_b,
+                                    uint16_t block_size) {
+  if ((block_a == NULL) || (block_b == NULL) || (block_size == 0)) {
+    return ADXL345_ERR_PARAM;
+  }
+  pp->blocks[0] = block_a;
+  pp->blocks[1] = block_b;
+  pp->block_size = block_size;
+  adxl345_pingpong_reset(pp);
+  return ADXL345_ERR_NONE;
+}
+
+void adxl345_pingpong_reset(adxl345_pingpong_t *pp) {
+  pp->fill_count = 0;
+  pp->fill = 0;
+  pp->ready = ADXL345_PINGPONG_NONE;
+  pp->in_use = false;
+  pp->completed = 0;
+  pp->overruns = 0;
+}
+
+// ==========================================
+// producer side
+
+adxl345_err_t adxl345_pingpong_service(adxl345_pingpong_t *pp,
+                                       adxl345_t *adxl345) {
+  uint8_t available;
+  adxl345_err_t err;
+
+  err = adxl345_available_samples(adxl345, &available);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  while (available > 0) {
+    adxl345_isample_t *dst;
+    uint16_t n = adxl345_pingpong_fill_span(pp, &dst);
+    if (n > available) n = available;
+
+    err = adxl345_get_isamples(adxl345, dst, n);
+    if (err != ADXL345_ERR_NONE) return err;
+
+    adxl345_pingpong_produced(pp, n);
+    available -= n;
+  }
+  return ADXL345_ERR_NONE;
+}
+
+uint16_t adxl345_pingpong_fill_span(adxl345_pingpong_t *pp,
+                                    adxl345_isample_t **dst) {
+  *dst = &pp->blocks[pp->fill][pp->fill_count];
+  return pp->block_size - pp->fill_count;
+}
+
+void adxl345_pingpong_produced(adxl345_pingpong_t *pp, uint16_t n) {
+  pp->fill_count += n;
+  if (pp->fill_count >= pp->block_size) {
+    complete_block(pp);
+  }
+}
+
+// ==========================================
+// consumer side
+
+bool adxl345_pingpong_acquire(adxl345_pingpong_t *pp,
+                              const adxl345_isample_t **block) {
+  uint32_t ready = LOAD_ACQUIRE(&pp->ready);
+
+  if (ready == ADXL345_PINGPONG_NONE) return false;
+
+  // Claim the block before clearing ready so the producer never sees both
+  // "nothing ready" and "consumer idle" while we are taking it.
+  STORE_RELEASE(&pp->in_use, true);
+  STORE_RELEASE(&pp->ready, ADXL345_PINGPONG_NONE);
+  *block = pp->blocks[ready];
+  return true;
+}
+
+void adxl345_pingpong_release(adxl345_pingpong_t *pp) {
+  STORE_RELEASE(&pp->in_use, false);
+}
+
+// =============================================================================
+// local (static) code
+
+static void complete_block(adxl345_pingpong_t *pp) {
+  pp->fill_count = 0;
+
+  if ((LOAD_ACQUIRE(&pp->ready) != ADXL345_PINGPONG_NONE) ||
+      LOAD_ACQUIRE(&pp->in_use)) {
+    // consumer still owns the other block: drop this one and refill it.
+    pp->overruns += 1;
+    return;
+  }
+  STORE_RELEASE(&pp->ready, pp->fill);
+  pp->fill ^= 1;
+  pp->completed += 1;
+}
@@ -0,0 +1,132 @@
+/** @file adxl345_pingpong.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_PINGPONG_H_
+#define _ADXL345_PINGPONG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// types and definitions
+
+/** Value of adxl345_pingpong_t.ready when no block is waiting. */
+#define ADXL345_PINGPONG_NONE 0xFF
+
+/**
+ * Double-buffered block acquisition.
+ *
+ * One block is filled by the producer while the other belongs to the
+ * consumer.  When the fill block is complete it is handed to the consumer and
+ * the producer moves to the other block.  If the consumer has not yet released
+ * its block, the freshly filled block is discarded, counted as an overrun, and
+ * refilled from the start.
+ */
+typedef struct {
+  adxl345_isample_t *blocks[2];  ///< caller-supplied storage
+  uint16_t block_size;           ///< samples per block
+  uint16_t fill_count;           ///< samples in the fill block (producer)
+  volatile uint32_t fill;        ///< index of block being filled (producer)
+  volatile uint32_t ready;       ///< index of completed block, or NONE
+  volatile uint32_t in_use;      ///< true while the consumer holds a block
+  volatile uint32_t completed;   ///< number of blocks handed to the consumer
+  volatile uint32_t overruns;    ///< number of blocks discarded
+} adxl345_pingpong_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Initialize the engine with two blocks of block_size samples each.
+ */
+adxl345_err_t adxl345_pingpong_init(adxl345_pingpong_t *pp,
+                                    adxl345_isample_t *block_a,
+                                    adxl345_isample_t *block_b,
+                                    uint16_t block_size);
+
+/**
+ * @brief Discard all partial and completed blocks and clear the counters.
+ */
+void adxl345_pingpong_reset(adxl345_pingpong_t *pp);
+
+// ==========================================
+// producer side
+
+/**
+ * @brief Synchronous backend: drain the ADXL345 FIFO into the fill block.
+ *
+ * Reads FIFO_STATUS once, then pops every available entry, completing (and
+ * swapping) blocks as they fill.  Call from the main loop, a timer, or the
+ * watermark interrupt.
+ */
+adxl345_err_t adxl345_pingpong_service(adxl345_pingpong_t *pp,
+                                       adxl345_t *adxl345);
+
+/**
+ * @brief Asynchronous / DMA backend: get the unfilled tail of the fill block.
+ *
+ * Sets *dst to the next free slot of the fill block and returns how many
+ * samples may be written there.  After the transfer completes, report the
+ * number written with adxl345_pingpong_produced().
+ */
+uint16_t adxl345_pingpong_fill_span(adxl345_pingpong_t *pp,
+                                    adxl345_isample_t **dst);
+
+/**
+ * @brief Account for n samples written into the span from fill_span().
+ */
+void adxl345_pingpong_produced(adxl345_pingpong_t *pp, uint16_t n);
+
+// ==========================================
+// consumer side
+
+/**
+ * @brief Take ownership of the most recently completed block.
+ *
+ * Returns false if no block is ready.  On success *block points at
+ * block_size samples which remain valid until adxl345_pingpong_release().
+ */
+bool adxl345_pingpong_acquire(adxl345_pingpong_t *pp,
+                              const adxl345_isample_t **block);
+
+/**
+ * @brief Return the block obtained from adxl345_pingpong_acquire().
+ */
+void adxl345_pingpong_release(adxl345_pingpong_t *pp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_PINGPONG_H_ */
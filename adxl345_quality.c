@@ -0,0 +1,135 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include <stddef.h>
+#include <string.h>
+#include "adxl345_quality.h"
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// local types and definitions
+
+// =============================================================================
+// local (forward) declarations
+
+static uint8_t classify(adxl345_quality_t *q, const adxl345_isample_t *s);
+
+static uint8_t saturated(int16_t v, int16_t full_scale);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+void adxl345_quality_init(adxl345_quality_t *q, uint8_t data_format,
+                          uint16_t stuck_limit) {
+  q->stuck_limit = stuck_limit;
+  q->run = 0;
+  q->last.x = q->last.y = q->last.z = 0;
+  adxl345_quality_set_format(q, data_format);
+  adxl345_quality_clear_stats(q);
+}
+
+void adxl345_quality_set_format(adxl345_quality_t *q, uint8_t data_format) {
+  q->full_scale = adxl345_format_full_scale(data_format);
+}
+
+adxl345_err_t adxl345_quality_read(adxl345_quality_t *q, adxl345_t *adxl345,
+                                   adxl345_isample_t *samples, uint8_t *flags,
+                                   uint8_t n, uint8_t *batch_flags) {
+  uint8_t all = 0;
+  adxl345_err_t err = ADXL345_ERR_NONE;
+
+  for (uint8_t i = 0; i < n; i++) {
+    err = adxl345_get_isample(adxl345, &samples[i]);
+    if (err != ADXL345_ERR_NONE) break;
+    uint8_t f = classify(q, &samples[i]);
+    if (flags != NULL) flags[i] = f;
+    all |= f;
+  }
+
+  if (batch_flags != NULL) *batch_flags = all;
+  return err;
+}
+
+uint8_t adxl345_quality_check(adxl345_quality_t *q,
+                              const adxl345_isample_t *samples,
+                              uint8_t *flags, uint16_t n) {
+  uint8_t all = 0;
+
+  for (uint16_t i = 0; i < n; i++) {
+    uint8_t f = classify(q, &samples[i]);
+    if (flags != NULL) flags[i] = f;
+    all |= f;
+  }
+  return all;
+}
+
+void adxl345_quality_get_stats(const adxl345_quality_t *q,
+                               adxl345_quality_stats_t *stats) {
+  *stats = q->stats;
+}
+
+void adxl345_quality_clear_stats(adxl345_quality_t *q) {
+  memset(&q->stats, 0, sizeof(q->stats));
+}
+
+// =============================================================================
+// local (static) code
+
+static uint8_t classify(adxl345_quality_t *q, const adxl345_isample_t *s) {
+  uint8_t f = saturated(s->x, q->full_scale) * ADXL345_QUALITY_SAT_X |
+              saturated(s->y, q->full_scale) * ADXL345_QUALITY_SAT_Y |
+              saturated(s->z, q->full_scale) * ADXL345_QUALITY_SAT_Z;
+
+  if ((s->x == q->last.x) && (s->y == q->last.y) && (s->z == q->last.z)) {
+    if (q->run < UINT16_MAX) q->run += 1;
+  } else {
+    q->run = 1;
+    q->last = *s;
+  }
+  if ((q->stuck_limit != 0) && (q->run >= q->stuck_limit)) {
+    f |= ADXL345_QUALITY_STUCK;
+  }
+  if ((s->x | s->y | s->z) == 0) f |= ADXL345_QUALITY_ZERO;
+
+  q->stats.samples += 1;
+  if (f != ADXL345_QUALITY_OK) {
+    q->stats.flagged += 1;
+    if (f & ADXL345_QUALITY_SATURATED) q->stats.saturated += 1;
+    if (f & ADXL345_QUALITY_STUCK) q->stats.stuck += 1;
+    if (f & ADXL345_QUALITY_ZERO) q->stats.zero += 1;
+  }
+  return f;
+}
+
+static uint8_t saturated(int16_t v, int16_t full_scale) {
+  // the negative rail is one code further out than the positive one
+  return (v >= full_scale) || (v < -full_scale);
+}
@@ -0,0 +1,127 @@
+/** @file adxl345_quality.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_QUALITY_H_
+#define _ADXL345_QUALITY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdint.h>
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// types and definitions
+
+typedef enum {
+  ADXL345_QUALITY_OK = 0x00,     ///< nothing suspicious
+  ADXL345_QUALITY_SAT_X = 0x01,  ///< X at the full-scale code
+  ADXL345_QUALITY_SAT_Y = 0x02,  ///< Y at the full-scale code
+  ADXL345_QUALITY_SAT_Z = 0x04,  ///< Z at the full-scale code
+  ADXL345_QUALITY_STUCK = 0x08,  ///< same reading stuck_limit times running
+  ADXL345_QUALITY_ZERO = 0x10,   ///< all three axes exactly zero
+} adxl345_quality_flags_t;
+
+#define ADXL345_QUALITY_SATURATED                                              \
+  (ADXL345_QUALITY_SAT_X | ADXL345_QUALITY_SAT_Y | ADXL345_QUALITY_SAT_Z)
+
+typedef struct {
+  uint32_t samples;    ///< samples checked
+  uint32_t flagged;    ///< samples with any flag set
+  uint32_t saturated;  ///< samples with at least one axis saturated
+  uint32_t stuck;      ///< samples flagged ADXL345_QUALITY_STUCK
+  uint32_t zero;       ///< samples flagged ADXL345_QUALITY_ZERO
+} adxl345_quality_stats_t;
+
+/**
+ * Per-sample quality checks.
+ *
+ * A sample is saturated on an axis when it reaches the full-scale code for
+ * the DATA_FORMAT in use.  It is stuck when it is bit-for-bit identical to
+ * the previous stuck_limit - 1 samples: real sensor noise makes that rare
+ * even at rest, while a frozen part or a bus that returns a latched value
+ * produces it every time.  An all-zero frame usually means the bus read
+ * nothing at all.
+ *
+ * The run-length state carries over between batches.
+ */
+typedef struct {
+  int16_t full_scale;        ///< largest positive code
+  uint16_t stuck_limit;      ///< identical samples before STUCK is raised
+  uint16_t run;              ///< identical samples seen so far
+  adxl345_isample_t last;    ///< previous sample
+  adxl345_quality_stats_t stats;
+} adxl345_quality_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Set up checks for the given DATA_FORMAT value.
+ *
+ * A stuck_limit of 0 disables the stuck check.
+ */
+void adxl345_quality_init(adxl345_quality_t *q, uint8_t data_format,
+                          uint16_t stuck_limit);
+
+/**
+ * @brief Follow a range or resolution change.  Counters are kept.
+ */
+void adxl345_quality_set_format(adxl345_quality_t *q, uint8_t data_format);
+
+/**
+ * @brief Pop n FIFO entries and check each one as it is decoded.
+ *
+ * flags may be NULL if only the counters are wanted; otherwise it receives
+ * one adxl345_quality_flags_t byte per sample.  *batch_flags (may be NULL)
+ * receives the OR of all sample flags.
+ */
+adxl345_err_t adxl345_quality_read(adxl345_quality_t *q, adxl345_t *adxl345,
+                                   adxl345_isample_t *samples, uint8_t *flags,
+                                   uint8_t n, uint8_t *batch_flags);
+
+/**
+ * @brief Check samples that have already been read.  Returns the OR of all
+ * sample flags.
+ */
+uint8_t adxl345_quality_check(adxl345_quality_t *q,
+                              const adxl345_isample_t *samples,
+                              uint8_t *flags, uint16_t n);
+
+void adxl345_quality_get_stats(const adxl345_quality_t *q,
+                               adxl345_quality_stats_t *stats);
+
+void adxl345_quality_clear_stats(adxl345_quality_t *q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_QUALITY_H_ */
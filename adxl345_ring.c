@@ -0,0 +1,170 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include <string.h>
+#include "adxl345_ring.h"
+#include "adxl345.h"
+#include "adxl345_atomic.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// local types and definitions
+
+// =============================================================================
+// local (forward) declarations
+
+static uint32_t min_u32(uint32_t a, uint32_t b);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+adxl345_err_t adxl345_ring_init(adxl345_ring_t *ring, adxl345_isample_t *buf,
+                                uint32_t capacity) {
+  if ((capacity == 0) || ((capacity & (capacity - 1)) != 0)) {
+    return ADXL345_ERR_PARAM;
+  }
+  ring->buf = buf;
+  ring->mask = capacity - 1;
+  ring->head = 0;
+  ring->tail = 0;
+  return ADXL345_ERR_NONE;
+}
+
+void adxl345_ring_reset(adxl345_ring_t *ring) {
+  ring->head = 0;
+  ring->tail = 0;
+}
+
+uint32_t adxl345_ring_capacity(const adxl345_ring_t *ring) {
+  return ring->mask + 1;
+}
+
+uint32_t adxl345_ring_count(const adxl345_ring_t *ring) {
+  return LOAD_ACQUIRE(&ring->head) - LOAD_ACQUIRE(&ring->tail);
+}
+
+uint32_t adxl345_ring_space(const adxl345_ring_t *ring) {
+  return adxl345_ring_capacity(ring) - adxl345_ring_count(ring);
+}
+
+bool adxl345_ring_is_empty(const adxl345_ring_t *ring) {
+  return adxl345_ring_count(ring) == 0;
+}
+
+bool adxl345_ring_is_full(const adxl345_ring_t *ring) {
+  return adxl345_ring_space(ring) == 0;
+}
+
+// ==========================================
+// producer side
+
+uint32_t adxl345_ring_push(adxl345_ring_t *ring,
+                           const adxl345_isample_t *samples, uint32_t n) {
+  uint32_t pushed = 0;
+
+  // at most two spans: up to the end of the buffer, then from the start.
+  while (pushed < n) {
+    adxl345_isample_t *span;
+    uint32_t len = min_u32(adxl345_ring_reserve(ring, &span), n - pushed);
+    if (len == 0) break;
+    memcpy(span, &samples[pushed], len * sizeof(adxl345_isample_t));
+    adxl345_ring_commit(ring, len);
+    pushed += len;
+  }
+  return pushed;
+}
+
+uint32_t adxl345_ring_reserve(adxl345_ring_t *ring, adxl345_isample_t **span) {
+  uint32_t head = ring->head;  // only the producer writes head
+  uint32_t space = adxl345_ring_capacity(ring) -
+                   (head - LOAD_ACQUIRE(&ring->tail));
+  uint32_t index = head & ring->mask;
+
+  *span = &ring->buf[index];
+  return min_u32(space, adxl345_ring_capacity(ring) - index);
+}
+
+void adxl345_ring_commit(adxl345_ring_t *ring, uint32_t n) {
+  STORE_RELEASE(&ring->head, ring->head + n);
+}
+
+adxl345_err_t adxl345_ring_fill(adxl345_ring_t *ring, adxl345_t *adxl345,
+                                uint8_t n, uint8_t *n_read) {
+  adxl345_err_t err = ADXL345_ERR_NONE;
+
+  *n_read = 0;
+  while (*n_read < n) {
+    adxl345_isample_t *span;
+    uint32_t len = min_u32(adxl345_ring_reserve(ring, &span), n - *n_read);
+    if (len == 0) break;
+    err = adxl345_get_isamples(adxl345, span, len);
+    if (err != ADXL345_ERR_NONE) break;
+    adxl345_ring_commit(ring, len);
+    *n_read += len;
+  }
+  return err;
+}
+
+// ==========================================
+// consumer side
+
+uint32_t adxl345_ring_pop(adxl345_ring_t *ring, adxl345_isample_t *samples,
+                          uint32_t n) {
+  uint32_t popped = 0;
+
+  while (popped < n) {
+    const adxl345_isample_t *span;
+    uint32_t len = min_u32(adxl345_ring_peek(ring, &span), n - popped);
+    if (len == 0) break;
+    memcpy(&samples[popped], span, len * sizeof(adxl345_isample_t));
+    adxl345_ring_release(ring, len);
+    popped += len;
+  }
+  return popped;
+}
+
+uint32_t adxl345_ring_peek(adxl345_ring_t *ring,
+                           const adxl345_isample_t **span) {
+  uint32_t tail = ring->tail;  // only the consumer writes tail
+  uint32_t count = LOAD_ACQUIRE(&ring->head) - tail;
+  uint32_t index = tail & ring->mask;
+
+  *span = &ring->buf[index];
+  return min_u32(count, adxl345_ring_capacity(ring) - index);
+}
+
+void adxl345_ring_release(adxl345_ring_t *ring, uint32_t n) {
+  STORE_RELEASE(&ring->tail, ring->tail + n);
+}
+
+// =============================================================================
+// local (static) code
+
+static uint32_t min_u32(uint32_t a, uint32_t b) { return (a < b) ? a : b; }
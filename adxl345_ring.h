@@ -0,0 +1,151 @@
+/** @file adxl345_ring.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_RING_H_
+#define _ADXL345_RING_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// types and definitions
+
+/**
+ * A single-producer / single-consumer ring of samples.
+ *
+ * The producer (typically an interrupt or DMA completion handler) only writes
+ * `head` and the consumer (typically the main loop) only writes `tail`.  Both
+ * indices run freely and are masked on access, so no lock is needed as long as
+ * there is exactly one producer and one consumer.
+ */
+typedef struct {
+  adxl345_isample_t *buf;  ///< caller-supplied storage
+  uint32_t mask;           ///< capacity - 1 (capacity is a power of two)
+  volatile uint32_t head;  ///< next slot to write (producer owned)
+  volatile uint32_t tail;  ///< next slot to read (consumer owned)
+} adxl345_ring_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Initialize a ring using caller-supplied storage.
+ *
+ * Returns ADXL345_ERR_PARAM unless capacity is a non-zero power of two.
+ */
+adxl345_err_t adxl345_ring_init(adxl345_ring_t *ring, adxl345_isample_t *buf,
+                                uint32_t capacity);
+
+/**
+ * @brief Discard all contents.  Only safe while neither side is active.
+ */
+void adxl345_ring_reset(adxl345_ring_t *ring);
+
+uint32_t adxl345_ring_capacity(const adxl345_ring_t *ring);
+
+/**
+ * @brief Number of samples available to the consumer.
+ */
+uint32_t adxl345_ring_count(const adxl345_ring_t *ring);
+
+/**
+ * @brief Number of free slots available to the producer.
+ */
+uint32_t adxl345_ring_space(const adxl345_ring_t *ring);
+
+bool adxl345_ring_is_empty(const adxl345_ring_t *ring);
+
+bool adxl345_ring_is_full(const adxl345_ring_t *ring);
+
+// ==========================================
+// producer side
+
+/**
+ * @brief Copy up to n samples into the ring.  Returns the number copied.
+ */
+uint32_t adxl345_ring_push(adxl345_ring_t *ring,
+                           const adxl345_isample_t *samples, uint32_t n);
+
+/**
+ * @brief Get the largest contiguous writable span without copying.
+ *
+ * Sets *span to the first free slot and returns the number of contiguous free
+ * slots (which may be less than adxl345_ring_space() when the free region
+ * wraps).  Fill some or all of them, then call adxl345_ring_commit().
+ */
+uint32_t adxl345_ring_reserve(adxl345_ring_t *ring, adxl345_isample_t **span);
+
+/**
+ * @brief Publish n samples previously written into a reserved span.
+ */
+void adxl345_ring_commit(adxl345_ring_t *ring, uint32_t n);
+
+/**
+ * @brief Read up to n samples from the ADXL345 FIFO directly into the ring.
+ *
+ * Samples are decoded straight into reserved spans (at most two when the
+ * free region wraps), so no intermediate copy is made.  n is clipped to the
+ * available space; *n_read reports how many were actually committed.
+ */
+adxl345_err_t adxl345_ring_fill(adxl345_ring_t *ring, adxl345_t *adxl345,
+                                uint8_t n, uint8_t *n_read);
+
+// ==========================================
+// consumer side
+
+/**
+ * @brief Copy up to n samples out of the ring.  Returns the number copied.
+ */
+uint32_t adxl345_ring_pop(adxl345_ring_t *ring, adxl345_isample_t *samples,
+                          uint32_t n);
+
+/**
+ * @brief Get the largest contiguous readable span without copying.
+ *
+ * Sets *span to the oldest sample and returns the number of contiguous
+ * samples.  Process some or all of them, then call adxl345_ring_release().
+ */
+uint32_t adxl345_ring_peek(adxl345_ring_t *ring,
+                           const adxl345_isample_t **span);
+
+/**
+ * @brief Return n samples previously obtained via adxl345_ring_peek().
+ */
+void adxl345_ring_release(adxl345_ring_t *ring, uint32_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_RING_H_ */
@@ -0,0 +1,129 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include <string.h>
+#include "adxl345_seq.h"
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// local types and definitions
+
+// microseconds * millihertz per sample
+#define US_MHZ_PER_SAMPLE 1000000000ULL
+
+// =============================================================================
+// local (forward) declarations
+
+static void push_gap(adxl345_seq_t *seq, uint32_t first_seq, uint32_t count);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+void adxl345_seq_init(adxl345_seq_t *seq, uint32_t odr_mhz) {
+  memset(seq, 0, sizeof(adxl345_seq_t));
+  seq->odr_mhz = odr_mhz;
+}
+
+void adxl345_seq_set_odr(adxl345_seq_t *seq, uint32_t odr_mhz) {
+  seq->odr_mhz = odr_mhz;
+}
+
+adxl345_err_t adxl345_seq_read_overrun(adxl345_t *adxl345, bool *overrun) {
+  uint8_t reg;
+  adxl345_err_t err = adxl345_read_reg(adxl345, ADXL345_REG_INT_SOURCE, &reg);
+  *overrun = (err == ADXL345_ERR_NONE) && (reg & ADXL345_OVERRUN_INT);
+  return err;
+}
+
+bool adxl345_seq_batch(adxl345_seq_t *seq, uint8_t entries, uint8_t n_drained,
+                       bool overrun, uint32_t now_us, uint32_t *first_seq) {
+  bool gap = false;
+
+  if (overrun) {
+    // Everything produced since the previous drain, plus what was left behind
+    // then, competed for the FIFO; only the newest `entries` survived.
+    uint32_t lost = 1;
+    if (seq->has_last) {
+      uint32_t elapsed_us = now_us - seq->last_us;
+      uint64_t produced = ((uint64_t)elapsed_us * seq->odr_mhz +
+                           US_MHZ_PER_SAMPLE / 2) / US_MHZ_PER_SAMPLE;
+      uint64_t kept = entries;
+      if (produced + seq->remaining > kept) {
+        lost = (uint32_t)(produced + seq->remaining - kept);
+      }
+    }
+    push_gap(seq, seq->next_seq, lost);
+    seq->next_seq += lost;
+    seq->stats.overruns += 1;
+    seq->stats.lost += lost;
+    gap = true;
+  }
+
+  *first_seq = seq->next_seq;
+  seq->next_seq += n_drained;
+  seq->remaining = (entries > n_drained) ? entries - n_drained : 0;
+  seq->last_us = now_us;
+  seq->has_last = true;
+  seq->stats.samples += n_drained;
+  seq->stats.batches += 1;
+  return gap;
+}
+
+bool adxl345_seq_pop_gap(adxl345_seq_t *seq, adxl345_gap_t *gap) {
+  if (seq->gap_count == 0) return false;
+  *gap = seq->gaps[seq->gap_head];
+  seq->gap_head = (seq->gap_head + 1) % ADXL345_SEQ_MAX_GAPS;
+  seq->gap_count -= 1;
+  return true;
+}
+
+void adxl345_seq_get_stats(const adxl345_seq_t *seq,
+                           adxl345_seq_stats_t *stats) {
+  *stats = seq->stats;
+}
+
+// =============================================================================
+// local (static) code
+
+static void push_gap(adxl345_seq_t *seq, uint32_t first_seq, uint32_t count) {
+  uint8_t index;
+
+  if (seq->gap_count == ADXL345_SEQ_MAX_GAPS) {
+    // drop the oldest record: the newest gap is the most useful one.
+    seq->gap_head = (seq->gap_head + 1) % ADXL345_SEQ_MAX_GAPS;
+    seq->gap_count -= 1;
+    seq->stats.gaps_dropped += 1;
+  }
+  index = (seq->gap_head + seq->gap_count) % ADXL345_SEQ_MAX_GAPS;
+  seq->gaps[index].first_seq = first_seq;
+  seq->gaps[index].count = count;
+  seq->gap_count += 1;
+}
@@ -0,0 +1,134 @@
+/** @file adxl345_seq.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_SEQ_H_
+#define _ADXL345_SEQ_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// types and definitions
+
+/** Number of gap records retained until popped. */
+#define ADXL345_SEQ_MAX_GAPS 8
+
+/**
+ * A run of samples known to be missing from the delivered stream.
+ */
+typedef struct {
+  uint32_t first_seq;  ///< sequence number of the first missing sample
+  uint32_t count;      ///< number of consecutive missing samples
+} adxl345_gap_t;
+
+typedef struct {
+  uint32_t samples;       ///< samples delivered
+  uint32_t batches;       ///< drains accounted
+  uint32_t overruns;      ///< drains on which an overrun was detected
+  uint32_t lost;          ///< samples skipped over by gap records
+  uint32_t gaps_dropped;  ///< gap records lost because the queue was full
+} adxl345_seq_stats_t;
+
+/**
+ * Sample sequence tracker.
+ *
+ * Every sample that has been or would have been produced by the ADXL345 gets
+ * a sequence number.  On each drain the tracker is told how many entries the
+ * FIFO held and how many were read; when an overrun is flagged, the number of
+ * samples discarded by the FIFO is estimated from the ODR and the time since
+ * the previous drain, the sequence counter skips over them, and a gap record
+ * is queued.
+ */
+typedef struct {
+  uint32_t next_seq;     ///< sequence number of the next delivered sample
+  uint32_t odr_mhz;      ///< output data rate
+  uint32_t last_us;      ///< time of the previous drain
+  uint8_t remaining;     ///< entries left in the FIFO after that drain
+  bool has_last;         ///< false until the first drain
+  adxl345_gap_t gaps[ADXL345_SEQ_MAX_GAPS];
+  uint8_t gap_head;      ///< index of oldest queued gap
+  uint8_t gap_count;     ///< number of queued gaps
+  adxl345_seq_stats_t stats;
+} adxl345_seq_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Initialize a tracker for a stream at the given ODR.
+ */
+void adxl345_seq_init(adxl345_seq_t *seq, uint32_t odr_mhz);
+
+/**
+ * @brief Change the ODR used for loss estimates (e.g. after a BW_RATE write).
+ */
+void adxl345_seq_set_odr(adxl345_seq_t *seq, uint32_t odr_mhz);
+
+/**
+ * @brief Read INT_SOURCE and report whether the FIFO has overrun.
+ */
+adxl345_err_t adxl345_seq_read_overrun(adxl345_t *adxl345, bool *overrun);
+
+/**
+ * @brief Account for one drain and assign sequence numbers to it.
+ *
+ * @param entries FIFO entries present when the drain started
+ *        (from FIFO_STATUS, or the watermark when it was not read).
+ * @param n_drained Number of entries read.
+ * @param overrun True if OVERRUN was seen in INT_SOURCE.
+ * @param now_us Time of the drain, from a free-running microsecond clock.
+ * @param first_seq Receives the sequence number of the first drained sample;
+ *        the rest follow consecutively.
+ *
+ * @return true if a gap was recorded immediately before this batch.
+ */
+bool adxl345_seq_batch(adxl345_seq_t *seq, uint8_t entries, uint8_t n_drained,
+                       bool overrun, uint32_t now_us, uint32_t *first_seq);
+
+/**
+ * @brief Remove the oldest gap record.  Returns false if none is queued.
+ */
+bool adxl345_seq_pop_gap(adxl345_seq_t *seq, adxl345_gap_t *gap);
+
+/**
+ * @brief Get a copy of the counters.
+ */
+void adxl345_seq_get_stats(const adxl345_seq_t *seq,
+                           adxl345_seq_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_SEQ_H_ */
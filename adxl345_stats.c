@@ -0,0 +1,143 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include <math.h>
+#include "adxl345_stats.h"
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// local types and definitions
+
+// =============================================================================
+// local (forward) declarations
+
+static void start(adxl345_stats_acc_t *acc, int16_t ref);
+
+static void accumulate(adxl345_stats_acc_t *acc, int16_t x);
+
+static void finish(const adxl345_stats_acc_t *acc, uint16_t n,
+                   adxl345_stats_result_t *r);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+adxl345_err_t adxl345_stats_init(adxl345_stats_t *st, uint16_t window) {
+  if ((window < 2) || (window > ADXL345_STATS_MAX_WINDOW)) {
+    return ADXL345_ERR_PARAM;
+  }
+  st->window = window;
+  st->windows = 0;
+  for (uint8_t a = 0; a < 3; a++) start(&st->acc[a], 0);
+  st->count = 0;
+  return ADXL345_ERR_NONE;
+}
+
+void adxl345_stats_reset(adxl345_stats_t *st) {
+  for (uint8_t a = 0; a < 3; a++) start(&st->acc[a], st->acc[a].ref);
+  st->count = 0;
+}
+
+bool adxl345_stats_feed(adxl345_stats_t *st, const adxl345_isample_t *samples,
+                        uint16_t n) {
+  bool completed = false;
+
+  for (uint16_t i = 0; i < n; i++) {
+    accumulate(&st->acc[0], samples[i].x);
+    accumulate(&st->acc[1], samples[i].y);
+    accumulate(&st->acc[2], samples[i].z);
+    if (++st->count < st->window) continue;
+
+    for (uint8_t a = 0; a < 3; a++) {
+      adxl345_stats_result_t *r = &st->result[a];
+      finish(&st->acc[a], st->count, r);
+      start(&st->acc[a], (int16_t)lroundf(r->mean));
+    }
+    st->count = 0;
+    st->windows += 1;
+    completed = true;
+  }
+  return completed;
+}
+
+// =============================================================================
+// local (static) code
+
+static void start(adxl345_stats_acc_t *acc, int16_t ref) {
+  acc->ref = ref;
+  acc->min = INT16_MAX;
+  acc->max = INT16_MIN;
+  acc->s1 = 0;
+  acc->s2 = 0;
+  acc->s3 = 0;
+  acc->s4 = 0;
+}
+
+static void accumulate(adxl345_stats_acc_t *acc, int16_t x) {
+  int32_t d = (int32_t)x - acc->ref;
+  int64_t d2;
+
+  // keeps s4 within 64 bits over ADXL345_STATS_MAX_WINDOW samples
+  if (d > ADXL345_STATS_MAX_DEVIATION) d = ADXL345_STATS_MAX_DEVIATION;
+  if (d < -ADXL345_STATS_MAX_DEVIATION) d = -ADXL345_STATS_MAX_DEVIATION;
+  d2 = (int64_t)d * d;
+
+  if (x < acc->min) acc->min = x;
+  if (x > acc->max) acc->max = x;
+  acc->s1 += d;
+  acc->s2 += (uint64_t)d2;
+  acc->s3 += d2 * d;
+  acc->s4 += (uint64_t)d2 * (uint64_t)d2;
+}
+
+static void finish(const adxl345_stats_acc_t *acc, uint16_t n,
+                   adxl345_stats_result_t *r) {
+  double m1 = (double)acc->s1 / n;
+  double e2 = (double)acc->s2 / n;
+  double e3 = (double)acc->s3 / n;
+  double e4 = (double)acc->s4 / n;
+  // raw moments about ref to central moments about the mean
+  double m2 = e2 - m1 * m1;
+  double m4 = e4 - 4.0 * m1 * e3 + 6.0 * m1 * m1 * e2 - 3.0 * m1 * m1 * m1 * m1;
+  double mean = acc->ref + m1;
+  double hi = acc->max - mean;
+  double lo = mean - acc->min;
+
+  if (m2 < 0.0) m2 = 0.0;
+  r->mean = (float)mean;
+  r->variance = (float)m2;
+  r->rms = (float)sqrt(m2);
+  r->min = acc->min;
+  r->max = acc->max;
+  r->peak_to_peak = (uint16_t)(acc->max - acc->min);
+  r->peak = (float)((hi > lo) ? hi : lo);
+  r->crest = (m2 > 0.0) ? r->peak / r->rms : 0.0f;
+  r->kurtosis = (m2 > 0.0) ? (float)(m4 / (m2 * m2)) : 0.0f;
+}
@@ -0,0 +1,125 @@
+/** @file adxl345_stats.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_STATS_H_
+#define _ADXL345_STATS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// types and definitions
+
+/**
+ * Largest window.  With deviations clipped to ADXL345_STATS_MAX_DEVIATION the
+ * fourth-power sum of a full window is at most 2^11 * 2^52 = 2^63, which
+ * fits the unsigned 64-bit sum.
+ */
+#define ADXL345_STATS_MAX_WINDOW 2048
+
+/**
+ * Largest |x - ref| accumulated, 2^13 LSB.  Right-justified data of any
+ * range, including +/-16 g full resolution, never deviates further from a
+ * previous mean; larger deviations (left-justified data) are clipped.
+ */
+#define ADXL345_STATS_MAX_DEVIATION 8192
+
+/**
+ * Statistics of one axis over one window, in LSB.  Everything except mean is
+ * taken about the window mean, so gravity does not inflate RMS or crest
+ * factor.
+ */
+typedef struct {
+  float mean;
+  float rms;        ///< standard deviation
+  float variance;
+  float peak;       ///< largest |x - mean|
+  int16_t min;
+  int16_t max;
+  uint16_t peak_to_peak;
+  float crest;      ///< peak / rms, 0 for a constant signal
+  float kurtosis;   ///< m4 / m2^2: 3 for Gaussian noise, 1.5 for a sine
+} adxl345_stats_result_t;
+
+/** Running sums of one axis. */
+typedef struct {
+  int16_t ref;  ///< offset subtracted before summing
+  int16_t min;
+  int16_t max;
+  int32_t s1;
+  uint64_t s2;
+  int64_t s3;
+  uint64_t s4;
+} adxl345_stats_acc_t;
+
+/**
+ * Windowed per-axis statistics in one pass with constant memory.
+ *
+ * Each sample updates integer power sums of its deviation from a reference,
+ * the previous window's mean, which keeps the sums small and the final
+ * moment arithmetic well conditioned.  The conversion to central moments is
+ * done once per window in double.
+ */
+typedef struct {
+  adxl345_stats_acc_t acc[3];
+  adxl345_stats_result_t result[3];  ///< last completed window
+  uint16_t window;
+  uint16_t count;
+  uint32_t windows;  ///< windows completed
+} adxl345_stats_t;
+
+// =============================================================================
+// declarations
+
+adxl345_err_t adxl345_stats_init(adxl345_stats_t *st, uint16_t window);
+
+/**
+ * @brief Discard the partial window.
+ */
+void adxl345_stats_reset(adxl345_stats_t *st);
+
+/**
+ * @brief Accumulate n samples.
+ *
+ * Returns true if a window completed during this call; its figures stay in
+ * st->result until the next one completes.
+ */
+bool adxl345_stats_feed(adxl345_stats_t *st, const adxl345_isample_t *samples,
+                        uint16_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_STATS_H_ */
@@ -0,0 +1,193 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include <stddef.h>
+#include <string.h>
+#include "adxl345_store.h"
+#include "adxl345.h"
+#include "adxl345_calib.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// local types and definitions
+
+#define CRC32_POLY 0xEDB88320UL
+
+#define IMAGE_INDEX(reg) ((reg) - ADXL345_STORE_REG_FIRST)
+
+// =============================================================================
+// local (forward) declarations
+
+static uint32_t image_crc(const adxl345_store_image_t *image);
+
+static adxl345_err_t apply_reg(adxl345_t *adxl345,
+                               const adxl345_store_image_t *image,
+                               uint8_t reg);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+adxl345_err_t adxl345_store_capture(adxl345_t *adxl345,
+                                    const adxl345_calib_coefs_t *calib,
+                                    adxl345_store_image_t *image) {
+  uint32_t config_mask = adxl345_snapshot_config_mask();
+  adxl345_err_t err;
+
+  // clear padding too, since the CRC covers it
+  memset(image, 0, sizeof(*image));
+  image->magic = ADXL345_STORE_MAGIC;
+  image->version = ADXL345_STORE_VERSION;
+  image->size = sizeof(*image);
+
+  err = adxl345_read_regs(adxl345, ADXL345_STORE_REG_FIRST, image->regs,
+                          ADXL345_STORE_REG_COUNT);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  for (uint8_t i = 0; i < ADXL345_STORE_REG_COUNT; i++) {
+    if (!(config_mask & (1UL << i))) image->regs[i] = 0;
+  }
+
+  if (calib != NULL) {
+    image->calib = *calib;
+  } else {
+    adxl345_calib_identity(&image->calib);
+  }
+  image->crc = image_crc(image);
+  return ADXL345_ERR_NONE;
+}
+
+adxl345_err_t adxl345_store_save(const adxl345_store_backend_t *backend,
+                                 const adxl345_store_image_t *image) {
+  return backend->save(backend->ctx, image, sizeof(*image));
+}
+
+adxl345_err_t adxl345_store_load(const adxl345_store_backend_t *backend,
+                                 adxl345_store_image_t *image) {
+  adxl345_err_t err;
+
+  err = backend->load(backend->ctx, image, sizeof(*image));
+  if (err != ADXL345_ERR_NONE) return err;
+
+  if ((image->magic != ADXL345_STORE_MAGIC) ||
+      (image->version != ADXL345_STORE_VERSION) ||
+      (image->size != sizeof(*image)) || (image->crc != image_crc(image))) {
+    return ADXL345_ERR_VERIFY;
+  }
+  return ADXL345_ERR_NONE;
+}
+
+adxl345_err_t adxl345_store_matches(adxl345_t *adxl345,
+                                    const adxl345_store_image_t *image,
+                                    bool *match) {
+  uint8_t regs[ADXL345_STORE_REG_COUNT];
+  uint32_t config_mask = adxl345_snapshot_config_mask();
+  adxl345_err_t err;
+
+  *match = false;
+  err = adxl345_read_regs(adxl345, ADXL345_STORE_REG_FIRST, regs,
+                          ADXL345_STORE_REG_COUNT);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  for (uint8_t i = 0; i < ADXL345_STORE_REG_COUNT; i++) {
+    if (!(config_mask & (1UL << i))) continue;
+    if (regs[i] != image->regs[i]) return ADXL345_ERR_NONE;
+  }
+  *match = true;
+  return ADXL345_ERR_NONE;
+}
+
+adxl345_err_t adxl345_store_apply(adxl345_t *adxl345,
+                                  const adxl345_store_image_t *image) {
+  adxl345_err_t err;
+
+  err = adxl345_write_reg(adxl345, ADXL345_REG_POWER_CTL, 0, true);
+  if (err != ADXL345_ERR_NONE) return err;
+  err = adxl345_write_reg(adxl345, ADXL345_REG_INT_ENABLE, 0, true);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  for (uint8_t reg = ADXL345_REG_THRESH_TAP; reg <= ADXL345_REG_TAP_AXES;
+       reg++) {
+    err = apply_reg(adxl345, image, reg);
+    if (err != ADXL345_ERR_NONE) return err;
+  }
+
+  err = apply_reg(adxl345, image, ADXL345_REG_BW_RATE);
+  if (err != ADXL345_ERR_NONE) return err;
+  err = apply_reg(adxl345, image, ADXL345_REG_INT_MAP);
+  if (err != ADXL345_ERR_NONE) return err;
+  err = apply_reg(adxl345, image, ADXL345_REG_DATA_FORMAT);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  err = adxl345_write_reg(adxl345, ADXL345_REG_FIFO_CTL,
+                          ADXL345_FIFO_MODE_BYPASS, false);
+  if (err != ADXL345_ERR_NONE) return err;
+  err = apply_reg(adxl345, image, ADXL345_REG_FIFO_CTL);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  err = apply_reg(adxl345, image, ADXL345_REG_INT_ENABLE);
+  if (err != ADXL345_ERR_NONE) return err;
+  return apply_reg(adxl345, image, ADXL345_REG_POWER_CTL);
+}
+
+adxl345_err_t adxl345_store_warm_boot(adxl345_t *adxl345,
+                                      const adxl345_store_backend_t *backend,
+                                      adxl345_store_image_t *image,
+                                      bool *warm) {
+  adxl345_err_t err;
+
+  *warm = false;
+  err = adxl345_store_load(backend, image);
+  if (err == ADXL345_ERR_VERIFY) return ADXL345_ERR_NONE;
+  if (err != ADXL345_ERR_NONE) return err;
+
+  return adxl345_store_matches(adxl345, image, warm);
+}
+
+// =============================================================================
+// local (static) code
+
+static uint32_t image_crc(const adxl345_store_image_t *image) {
+  const uint8_t *p = (const uint8_t *)image;
+  uint32_t crc = 0xFFFFFFFFUL;
+
+  for (size_t i = 0; i < offsetof(adxl345_store_image_t, crc); i++) {
+    crc ^= p[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ CRC32_POLY : crc >> 1;
+    }
+  }
+  return ~crc;
+}
+
+static adxl345_err_t apply_reg(adxl345_t *adxl345,
+                               const adxl345_store_image_t *image,
+                               uint8_t reg) {
+  return adxl345_write_reg(adxl345, reg, image->regs[IMAGE_INDEX(reg)], true);
+}
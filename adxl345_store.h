@@ -0,0 +1,137 @@
+/** @file adxl345_store.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_STORE_H_
+#define _ADXL345_STORE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345.h"
+#include "adxl345_calib.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// types and definitions
+
+#define ADXL345_STORE_MAGIC 0x35344C41  ///< "AL45" little-endian
+#define ADXL345_STORE_VERSION 1
+
+/** The register image runs from THRESH_TAP (0x1D) to FIFO_CTL (0x38). */
+#define ADXL345_STORE_REG_FIRST ADXL345_REG_THRESH_TAP
+#define ADXL345_STORE_REG_COUNT                                                \
+  (ADXL345_REG_FIFO_CTL - ADXL345_REG_THRESH_TAP + 1)
+
+/**
+ * Where images are kept.  load() fills n bytes (the contents need not be
+ * valid; the image is checked afterwards) and save() replaces them.
+ */
+typedef struct {
+  adxl345_err_t (*load)(void *ctx, void *dst, uint16_t n);
+  adxl345_err_t (*save)(void *ctx, const void *src, uint16_t n);
+  void *ctx;
+} adxl345_store_backend_t;
+
+/**
+ * Last known good configuration: the writable registers and the
+ * calibration coefficients, protected by a CRC-32.  Read-only registers in
+ * the span are stored as zero.
+ */
+typedef struct {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size;                           ///< sizeof(adxl345_store_image_t)
+  uint8_t regs[ADXL345_STORE_REG_COUNT];   ///< 0x1D..0x38
+  adxl345_calib_coefs_t calib;
+  uint32_t crc;                            ///< CRC-32 of everything above
+} adxl345_store_image_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Build an image from the device's current registers.
+ *
+ * calib may be NULL to store identity coefficients.  The registers are read
+ * with one burst, so one FIFO entry is consumed.
+ */
+adxl345_err_t adxl345_store_capture(adxl345_t *adxl345,
+                                    const adxl345_calib_coefs_t *calib,
+                                    adxl345_store_image_t *image);
+
+adxl345_err_t adxl345_store_save(const adxl345_store_backend_t *backend,
+                                 const adxl345_store_image_t *image);
+
+/**
+ * @brief Load an image.  Returns ADXL345_ERR_VERIFY if it is missing,
+ * from another version, or fails its checksum.
+ */
+adxl345_err_t adxl345_store_load(const adxl345_store_backend_t *backend,
+                                 adxl345_store_image_t *image);
+
+/**
+ * @brief Compare a single burst read of 0x1D..0x38 against the image.
+ *
+ * Read-only registers are ignored.  The burst pops one FIFO entry and
+ * clears latched tap, activity and free-fall bits in INT_SOURCE.
+ */
+adxl345_err_t adxl345_store_matches(adxl345_t *adxl345,
+                                    const adxl345_store_image_t *image,
+                                    bool *match);
+
+/**
+ * @brief Write the image's registers to the device.
+ *
+ * The part is put in standby first and POWER_CTL is written last, with the
+ * FIFO passed through bypass so it starts empty.
+ */
+adxl345_err_t adxl345_store_apply(adxl345_t *adxl345,
+                                  const adxl345_store_image_t *image);
+
+/**
+ * @brief Warm-boot check: load the stored image and compare it with the
+ * device.
+ *
+ * *warm is true when a valid image matches the registers, in which case
+ * reset and configuration can be skipped and image->calib used as is.
+ * Otherwise the caller configures from scratch (or with
+ * adxl345_store_apply()) and saves a fresh image.
+ */
+adxl345_err_t adxl345_store_warm_boot(adxl345_t *adxl345,
+                                      const adxl345_store_backend_t *backend,
+                                      adxl345_store_image_t *image,
+                                      bool *warm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_STORE_H_ */
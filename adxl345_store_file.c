@@ -0,0 +1,96 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include <stdio.h>
+#include "adxl345_store_file.h"
+#include "adxl345_err.h"
+#include "adxl345_store.h"
+
+// =============================================================================
+// local types and definitions
+
+#define TMP_SUFFIX ".tmp"
+
+#define MAX_PATH 256
+
+// =============================================================================
+// local (forward) declarations
+
+static adxl345_err_t file_load(void *ctx, void *dst, uint16_t n);
+
+static adxl345_err_t file_save(void *ctx, const void *src, uint16_t n);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+void adxl345_store_file_init(adxl345_store_file_t *file, const char *path,
+                             adxl345_store_backend_t *backend) {
+  file->path = path;
+  backend->load = file_load;
+  backend->save = file_save;
+  backend->ctx = file;
+}
+
+// =============================================================================
+// local (static) code
+
+static adxl345_err_t file_load(void *ctx, void *dst, uint16_t n) {
+  adxl345_store_file_t *file = (adxl345_store_file_t *)ctx;
+  FILE *fp = fopen(file->path, "rb");
+  size_t got;
+
+  // a missing file is just an invalid image
+  if (fp == NULL) return ADXL345_ERR_VERIFY;
+  got = fread(dst, 1, n, fp);
+  fclose(fp);
+  return (got == n) ? ADXL345_ERR_NONE : ADXL345_ERR_VERIFY;
+}
+
+static adxl345_err_t file_save(void *ctx, const void *src, uint16_t n) {
+  adxl345_store_file_t *file = (adxl345_store_file_t *)ctx;
+  char tmp[MAX_PATH];
+  FILE *fp;
+  bool ok;
+
+  if (snprintf(tmp, sizeof(tmp), "%s" TMP_SUFFIX, file->path) >=
+      (int)sizeof(tmp)) {
+    return ADXL345_ERR_PARAM;
+  }
+
+  fp = fopen(tmp, "wb");
+  if (fp == NULL) return ADXL345_ERR_WRITE;
+  ok = (fwrite(src, 1, n, fp) == n);
+  ok = (fclose(fp) == 0) && ok;
+  if (!ok || (rename(tmp, file->path) != 0)) {
+    remove(tmp);
+    return ADXL345_ERR_WRITE;
+  }
+  return ADXL345_ERR_NONE;
+}
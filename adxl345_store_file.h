@@ -0,0 +1,66 @@
+/** @file adxl345_store_file.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_STORE_FILE_H_
+#define _ADXL345_STORE_FILE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include "adxl345_err.h"
+#include "adxl345_store.h"
+
+// =============================================================================
+// types and definitions
+
+/**
+ * Store backend for hosts: the image is kept in a file.  Saving writes a
+ * temporary file next to it and renames it over the old one, so a crash
+ * mid-save leaves the previous image intact.
+ */
+typedef struct {
+  const char *path;
+} adxl345_store_file_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Bind a file backend to path and fill in backend.
+ *
+ * path must stay valid while the backend is in use.
+ */
+void adxl345_store_file_init(adxl345_store_file_t *file, const char *path,
+                             adxl345_store_backend_t *backend);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_STORE_FILE_H_ */
@@ -0,0 +1,140 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include "adxl345_ts.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// local types and definitions
+
+// microseconds * millihertz per sample
+#define US_MHZ_PER_SAMPLE 1.0e9
+
+// =============================================================================
+// local (forward) declarations
+
+static void fit(adxl345_ts_t *ts);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+adxl345_err_t adxl345_ts_init(adxl345_ts_t *ts, uint32_t odr_mhz,
+                              uint32_t min_spacing_us) {
+  ts->min_spacing_us = min_spacing_us;
+  return adxl345_ts_reset(ts, odr_mhz);
+}
+
+adxl345_err_t adxl345_ts_reset(adxl345_ts_t *ts, uint32_t odr_mhz) {
+  if (odr_mhz == 0) return ADXL345_ERR_PARAM;
+  ts->head = 0;
+  ts->count = 0;
+  ts->period_us = US_MHZ_PER_SAMPLE / odr_mhz;
+  ts->base_us = 0.0;
+  ts->base_seq = 0;
+  return ADXL345_ERR_NONE;
+}
+
+bool adxl345_ts_anchor(adxl345_ts_t *ts, uint32_t first_seq, uint8_t entries,
+                       uint64_t now_us) {
+  adxl345_ts_anchor_t *anchor;
+
+  if (entries == 0) return false;
+
+  if (ts->count > 0) {
+    uint8_t newest = (ts->head + ts->count - 1) % ADXL345_TS_WINDOW;
+    if (now_us - ts->anchors[newest].us < ts->min_spacing_us) return false;
+  }
+
+  if (ts->count == ADXL345_TS_WINDOW) {
+    ts->head = (ts->head + 1) % ADXL345_TS_WINDOW;
+    ts->count -= 1;
+  }
+  anchor = &ts->anchors[(ts->head + ts->count) % ADXL345_TS_WINDOW];
+  anchor->seq = first_seq + entries - 1;
+  anchor->us = now_us;
+  ts->count += 1;
+
+  fit(ts);
+  return true;
+}
+
+uint64_t adxl345_ts_time_of(const adxl345_ts_t *ts, uint32_t seq) {
+  // signed distance, so samples just before the reference work too
+  int32_t dk = (int32_t)(seq - ts->base_seq);
+  double t = ts->base_us + dk * ts->period_us;
+  return (t > 0.0) ? (uint64_t)(t + 0.5) : 0;
+}
+
+uint32_t adxl345_ts_period_q8(const adxl345_ts_t *ts) {
+  return (uint32_t)(ts->period_us * 256.0 + 0.5);
+}
+
+uint32_t adxl345_ts_odr_mhz(const adxl345_ts_t *ts) {
+  return (uint32_t)(US_MHZ_PER_SAMPLE / ts->period_us + 0.5);
+}
+
+// =============================================================================
+// local (static) code
+
+static void fit(adxl345_ts_t *ts) {
+  const adxl345_ts_anchor_t *first = &ts->anchors[ts->head];
+  double mean_k = 0.0;
+  double mean_t = 0.0;
+  double sxx = 0.0;
+  double sxy = 0.0;
+
+  // Work relative to the oldest anchor to keep magnitudes small.
+  for (uint8_t i = 0; i < ts->count; i++) {
+    const adxl345_ts_anchor_t *a =
+        &ts->anchors[(ts->head + i) % ADXL345_TS_WINDOW];
+    mean_k += (double)(a->seq - first->seq);
+    mean_t += (double)(a->us - first->us);
+  }
+  mean_k /= ts->count;
+  mean_t /= ts->count;
+
+  for (uint8_t i = 0; i < ts->count; i++) {
+    const adxl345_ts_anchor_t *a =
+        &ts->anchors[(ts->head + i) % ADXL345_TS_WINDOW];
+    double dk = (double)(a->seq - first->seq) - mean_k;
+    double dt = (double)(a->us - first->us) - mean_t;
+    sxx += dk * dk;
+    sxy += dk * dt;
+  }
+
+  if (sxx > 0.0) {
+    ts->period_us = sxy / sxx;
+  }
+
+  // the fitted line passes through the centroid of the anchors
+  ts->base_seq = first->seq + (uint32_t)(mean_k + 0.5);
+  ts->base_us = (double)first->us + mean_t +
+                ((double)(ts->base_seq - first->seq) - mean_k) * ts->period_us;
+}
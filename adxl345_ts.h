@@ -0,0 +1,127 @@
+/** @file adxl345_ts.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_TS_H_
+#define _ADXL345_TS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345_err.h"
+
+// =============================================================================
+// types and definitions
+
+/** Number of anchors used by the regression. */
+#define ADXL345_TS_WINDOW 16
+
+typedef struct {
+  uint32_t seq;  ///< sequence number of the newest sample in the FIFO
+  uint64_t us;   ///< MCU time at which that sample was the newest
+} adxl345_ts_anchor_t;
+
+/**
+ * Sample timestamp reconstruction.
+ *
+ * The ADXL345 has no timestamps and its ODR clock is only good to a few
+ * percent, so a nominal period drifts by seconds per hour.  Instead, each
+ * drain (or watermark interrupt) anchors one sample's sequence number to MCU
+ * time.  A least-squares line through the most recent anchors gives both the
+ * true sample period and the time of any nearby sample; since the fit is
+ * continually refreshed, errors do not accumulate.
+ *
+ * Sequence numbers come from adxl345_seq (or any counter that advances by one
+ * per produced sample, including skipped ones).
+ */
+typedef struct {
+  adxl345_ts_anchor_t anchors[ADXL345_TS_WINDOW];
+  uint8_t head;             ///< index of the oldest anchor
+  uint8_t count;            ///< anchors held
+  uint32_t min_spacing_us;  ///< anchors closer than this are ignored
+  double period_us;         ///< estimated sample period
+  double base_us;           ///< fitted time of sample base_seq
+  uint32_t base_seq;        ///< reference sequence number for base_us
+} adxl345_ts_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Initialize with the nominal ODR, used until two anchors exist.
+ *
+ * Anchors arriving less than min_spacing_us after the previous accepted one
+ * are ignored, so the window spans a useful baseline even at high drain rates.
+ */
+adxl345_err_t adxl345_ts_init(adxl345_ts_t *ts, uint32_t odr_mhz,
+                              uint32_t min_spacing_us);
+
+/**
+ * @brief Discard all anchors and restart from a nominal ODR.
+ *
+ * Use after a BW_RATE change, since old anchors describe another rate.
+ */
+adxl345_err_t adxl345_ts_reset(adxl345_ts_t *ts, uint32_t odr_mhz);
+
+/**
+ * @brief Anchor a drain to MCU time.
+ *
+ * @param first_seq Sequence number of the first sample drained.
+ * @param entries FIFO entries present when now_us was taken; the newest of
+ *        them, first_seq + entries - 1, is taken to have been sampled at
+ *        now_us.  Timestamping in the watermark interrupt handler (entries ==
+ *        watermark) gives the least jitter.
+ * @param now_us MCU time in microseconds.
+ *
+ * @return true if the anchor was used.
+ */
+bool adxl345_ts_anchor(adxl345_ts_t *ts, uint32_t first_seq, uint8_t entries,
+                       uint64_t now_us);
+
+/**
+ * @brief Time in microseconds at which sample seq was taken.
+ */
+uint64_t adxl345_ts_time_of(const adxl345_ts_t *ts, uint32_t seq);
+
+/**
+ * @brief Estimated sample period in 1/256 microsecond units.
+ */
+uint32_t adxl345_ts_period_q8(const adxl345_ts_t *ts);
+
+/**
+ * @brief Estimated ODR in millihertz.
+ */
+uint32_t adxl345_ts_odr_mhz(const adxl345_ts_t *ts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_TS_H_ */
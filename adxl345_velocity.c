@@ -0,0 +1,157 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include <math.h>
+#include <string.h>
+#include "adxl345_velocity.h"
+#include "adxl345.h"
+#include "adxl345_biquad.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// local types and definitions
+
+#define PI 3.14159265358979323846f
+
+// nominal full-resolution scale, datasheet typical
+#define MG_PER_LSB 3.9f
+
+#define STANDARD_GRAVITY 9.80665f
+
+// samples filtered per pass
+#define CHUNK 32
+
+// integrator leak corner relative to the band's lower edge
+#define LEAK_RATIO 10.0f
+
+// Al-Alaoui integrator weights in eighths: 7/8 of the rectangular rule plus
+// 1/8 of the trapezoid rule
+#define WEIGHT_NOW 7
+#define WEIGHT_PREV 1
+
+// =============================================================================
+// local (forward) declarations
+
+static void integrate(adxl345_velocity_t *vel, uint8_t axis, int16_t a);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+adxl345_err_t adxl345_velocity_init(adxl345_velocity_t *vel,
+                                    const adxl345_velocity_config_t *config) {
+  float fs = config->fs_hz;
+  float leak_hz = config->lo_hz / LEAK_RATIO;
+  float g_per_lsb;
+  adxl345_err_t err;
+
+  if ((config->window == 0) || (config->data_format & ADXL345_LEFT_JUSTIFY) ||
+      (config->hi_hz > ADXL345_VELOCITY_MAX_BAND * fs)) {
+    return ADXL345_ERR_PARAM;
+  }
+
+  adxl345_biquad_init(&vel->band);
+  err = adxl345_biquad_add(&vel->band, ADXL345_BIQUAD_HIGHPASS, config->lo_hz,
+                           fs, 0.7071f);
+  if (err != ADXL345_ERR_NONE) return err;
+  if (config->hi_hz > 0.0f) {
+    err = adxl345_biquad_add(&vel->band, ADXL345_BIQUAD_LOWPASS,
+                             config->hi_hz, fs, 0.7071f);
+    if (err != ADXL345_ERR_NONE) return err;
+  }
+
+  vel->leak_q15 = (int32_t)lroundf((1.0f - 2.0f * PI * leak_hz / fs) * 32768.0f);
+  g_per_lsb = MG_PER_LSB * (1 << adxl345_format_shift(config->data_format)) /
+              1000.0f;
+  // LSB * samples -> g * s -> mm/s
+  vel->scale = g_per_lsb * STANDARD_GRAVITY * 1000.0f / fs;
+  vel->window = config->window;
+  adxl345_velocity_reset(vel);
+  return ADXL345_ERR_NONE;
+}
+
+void adxl345_velocity_reset(adxl345_velocity_t *vel) {
+  adxl345_biquad_reset(&vel->band);
+  memset(vel->integ, 0, sizeof(vel->integ));
+  memset(vel->prev, 0, sizeof(vel->prev));
+  memset(vel->sum_sq, 0, sizeof(vel->sum_sq));
+  memset(vel->peak, 0, sizeof(vel->peak));
+  vel->count = 0;
+}
+
+bool adxl345_velocity_feed(adxl345_velocity_t *vel,
+                           const adxl345_isample_t *samples, uint16_t n) {
+  adxl345_isample_t buf[CHUNK];
+  bool completed = false;
+
+  while (n > 0) {
+    uint16_t chunk = (n > CHUNK) ? CHUNK : n;
+
+    for (uint16_t i = 0; i < chunk; i++) buf[i] = samples[i];
+    adxl345_biquad_process(&vel->band, buf, chunk);
+
+    for (uint16_t i = 0; i < chunk; i++) {
+      integrate(vel, 0, buf[i].x);
+      integrate(vel, 1, buf[i].y);
+      integrate(vel, 2, buf[i].z);
+      if (++vel->count < vel->window) continue;
+
+      for (uint8_t k = 0; k < 3; k++) {
+        adxl345_velocity_result_t *r = &vel->result[k];
+        r->rms_mm_s = sqrtf((float)vel->sum_sq[k] / vel->count) * vel->scale;
+        r->peak_mm_s = vel->peak[k] * vel->scale;
+        vel->sum_sq[k] = 0;
+        vel->peak[k] = 0;
+      }
+      vel->count = 0;
+      completed = true;
+    }
+    samples += chunk;
+    n -= chunk;
+  }
+  return completed;
+}
+
+// =============================================================================
+// local (static) code
+
+static void integrate(adxl345_velocity_t *vel, uint8_t axis, int16_t a) {
+  // v[n] = leak * v[n-1] + (7 a[n] + a[n-1]) / 8, Q8.  The trapezoid rule
+  // reads (wT/2) / tan(wT/2) of the true integral, 34% low at 0.31 fs; this
+  // blend stays within 2% of 1/(jw) up to ADXL345_VELOCITY_MAX_BAND.
+  int32_t v = (int32_t)(((int64_t)vel->integ[axis] * vel->leak_q15) >> 15) +
+              (((int32_t)a * WEIGHT_NOW + vel->prev[axis] * WEIGHT_PREV) << 5);
+  int32_t lsb = v >> 8;
+  uint32_t mag = (uint32_t)(lsb < 0 ? -lsb : lsb);
+
+  vel->integ[axis] = v;
+  vel->prev[axis] = a;
+  vel->sum_sq[axis] += (uint64_t)((int64_t)lsb * lsb);
+  if (mag > vel->peak[axis]) vel->peak[axis] = mag;
+}
@@ -0,0 +1,153 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include <stddef.h>
+#include "adxl345_watermark.h"
+#include "adxl345.h"
+#include "adxl345_atomic.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// local types and definitions
+
+// D7:D6 of FIFO_CTL
+#define FIFO_MODE_MASK 0xC0
+
+// =============================================================================
+// local (forward) declarations
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+adxl345_err_t adxl345_watermark_init(adxl345_watermark_t *wm,
+                                     adxl345_t *adxl345,
+                                     adxl345_int_pin_t pin, uint8_t watermark,
+                                     const adxl345_int_hook_t *hook) {
+  adxl345_err_t err;
+
+  if ((watermark == 0) || (watermark > ADXL345_WATERMARK_MAX)) {
+    return ADXL345_ERR_PARAM;
+  }
+
+  wm->adxl345 = adxl345;
+  wm->hook.is_asserted = hook ? hook->is_asserted : NULL;
+  wm->hook.arg = hook ? hook->arg : NULL;
+  wm->pin = pin;
+  wm->watermark = watermark;
+  wm->pending = false;
+  wm->services = 0;
+  wm->samples = 0;
+  wm->transactions = 0;
+
+  // disable the interrupt while reconfiguring so a stale level is not seen.
+  err = adxl345_update_reg(adxl345, ADXL345_REG_INT_ENABLE,
+                           ADXL345_WATERMARK_INT, 0);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  // keep the caller's trigger routing (D5)
+  err = adxl345_update_reg(adxl345, ADXL345_REG_FIFO_CTL,
+                           FIFO_MODE_MASK | ADXL345_TRIGGER_WATERMARK_MASK,
+                           ADXL345_FIFO_MODE_STREAM | watermark);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  err = adxl345_update_reg(adxl345, ADXL345_REG_INT_MAP, ADXL345_WATERMARK_INT,
+                           (pin == ADXL345_INT2) ? ADXL345_WATERMARK_INT : 0);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  return adxl345_update_reg(adxl345, ADXL345_REG_INT_ENABLE,
+                            ADXL345_WATERMARK_INT, ADXL345_WATERMARK_INT);
+}
+
+adxl345_err_t adxl345_watermark_set_level(adxl345_watermark_t *wm,
+                                          uint8_t watermark) {
+  adxl345_err_t err;
+
+  if ((watermark == 0) || (watermark > ADXL345_WATERMARK_MAX)) {
+    return ADXL345_ERR_PARAM;
+  }
+  if (watermark == wm->watermark) return ADXL345_ERR_NONE;
+
+  err = adxl345_update_reg(wm->adxl345, ADXL345_REG_FIFO_CTL,
+                           ADXL345_TRIGGER_WATERMARK_MASK, watermark);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  wm->watermark = watermark;
+  return ADXL345_ERR_NONE;
+}
+
+adxl345_err_t adxl345_watermark_stop(adxl345_watermark_t *wm) {
+  adxl345_err_t err;
+
+  err = adxl345_update_reg(wm->adxl345, ADXL345_REG_INT_ENABLE,
+                           ADXL345_WATERMARK_INT, 0);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  STORE_RELEASE(&wm->pending, false);
+  return adxl345_write_reg(wm->adxl345, ADXL345_REG_FIFO_CTL,
+                           ADXL345_FIFO_MODE_BYPASS, true);
+}
+
+void adxl345_watermark_isr(adxl345_watermark_t *wm) {
+  STORE_RELEASE(&wm->pending, true);
+}
+
+bool adxl345_watermark_is_pending(const adxl345_watermark_t *wm) {
+  return LOAD_ACQUIRE(&wm->pending);
+}
+
+adxl345_err_t adxl345_watermark_service(adxl345_watermark_t *wm,
+                                        adxl345_isample_t *dst,
+                                        uint8_t capacity, uint8_t *n_read) {
+  uint8_t n = (wm->watermark < capacity) ? wm->watermark : capacity;
+  adxl345_err_t err;
+
+  *n_read = 0;
+  if (!LOAD_ACQUIRE(&wm->pending)) return ADXL345_ERR_NONE;
+
+  // clear before draining so an edge that arrives meanwhile is not lost.
+  STORE_RELEASE(&wm->pending, false);
+
+  err = adxl345_get_isamples(wm->adxl345, dst, n);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  *n_read = n;
+  wm->services += 1;
+  wm->samples += n;
+  wm->transactions += n;
+
+  if ((wm->hook.is_asserted != NULL) && wm->hook.is_asserted(wm->hook.arg)) {
+    // still at or above the watermark: no new edge will come, so stay armed.
+    STORE_RELEASE(&wm->pending, true);
+  }
+  return ADXL345_ERR_NONE;
+}
+
+// =============================================================================
+// local (static) code
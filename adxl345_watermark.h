@@ -0,0 +1,131 @@
+/** @file adxl345_watermark.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_WATERMARK_H_
+#define _ADXL345_WATERMARK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345.h"
+#include "adxl345_err.h"
+
+// =============================================================================
+// types and definitions
+
+/** Largest usable watermark (the FIFO holds 32 entries). */
+#define ADXL345_WATERMARK_MAX 31
+
+typedef enum {
+  ADXL345_INT1 = 0,  ///< route to the INT1 pin
+  ADXL345_INT2 = 1,  ///< route to the INT2 pin
+} adxl345_int_pin_t;
+
+/**
+ * Optional hook for sampling the level of the INT pin.
+ *
+ * The ADXL345 holds WATERMARK asserted for as long as the FIFO holds at least
+ * `watermark` entries.  With an edge-triggered MCU interrupt, a drain that
+ * leaves the FIFO above the watermark produces no new edge; when a hook is
+ * given, the service routine checks the level after draining and stays
+ * pending if it is still asserted.  On a host the hook can be simulated.
+ */
+typedef struct {
+  bool (*is_asserted)(void *arg);  ///< return true while INT is asserted
+  void *arg;                       ///< passed to is_asserted
+} adxl345_int_hook_t;
+
+typedef struct {
+  adxl345_t *adxl345;         ///< the device being serviced
+  adxl345_int_hook_t hook;    ///< optional INT level hook
+  adxl345_int_pin_t pin;      ///< pin WATERMARK is routed to
+  uint8_t watermark;          ///< FIFO entries per interrupt
+  volatile uint32_t pending;  ///< set by adxl345_watermark_isr()
+  uint32_t services;          ///< number of drains performed
+  uint32_t samples;           ///< total samples read
+  uint32_t transactions;      ///< total bus transactions issued
+} adxl345_watermark_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Program the ADXL345 for watermark-driven FIFO servicing.
+ *
+ * Puts the FIFO in stream mode with the given watermark, routes
+ * ADXL345_WATERMARK_INT to pin in INT_MAP and enables it in INT_ENABLE.  Other
+ * bits of FIFO_CTL, INT_MAP and INT_ENABLE are preserved.  hook may be NULL.
+ */
+adxl345_err_t adxl345_watermark_init(adxl345_watermark_t *wm,
+                                     adxl345_t *adxl345,
+                                     adxl345_int_pin_t pin, uint8_t watermark,
+                                     const adxl345_int_hook_t *hook);
+
+/**
+ * @brief Change the watermark, preserving the FIFO mode bits.
+ *
+ * Smaller values lower latency; larger values amortize bus overhead.
+ */
+adxl345_err_t adxl345_watermark_set_level(adxl345_watermark_t *wm,
+                                          uint8_t watermark);
+
+/**
+ * @brief Disable the watermark interrupt and return the FIFO to bypass mode.
+ */
+adxl345_err_t adxl345_watermark_stop(adxl345_watermark_t *wm);
+
+/**
+ * @brief Note that the INT pin fired.  Safe to call from an interrupt.
+ */
+void adxl345_watermark_isr(adxl345_watermark_t *wm);
+
+/**
+ * @brief True if an interrupt is waiting to be serviced.
+ */
+bool adxl345_watermark_is_pending(const adxl345_watermark_t *wm);
+
+/**
+ * @brief Drain one watermark's worth of samples if the INT pin has fired.
+ *
+ * Does not touch the bus unless adxl345_watermark_isr() has been called.  The
+ * FIFO is known to hold at least `watermark` entries, so no FIFO_STATUS read
+ * is needed: exactly min(watermark, capacity) entries are popped.  *n_read is
+ * zero if nothing was pending.
+ */
+adxl345_err_t adxl345_watermark_service(adxl345_watermark_t *wm,
+                                        adxl345_isample_t *dst,
+                                        uint8_t capacity, uint8_t *n_read);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_WATERMARK_H_ */
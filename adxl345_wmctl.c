@@ -0,0 +1,166 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// =============================================================================
+// includes
+
+#include <stddef.h>
+#include "adxl345_wmctl.h"
+#include "adxl345.h"
+#include "adxl345_err.h"
+#include "adxl345_watermark.h"
+
+// =============================================================================
+// local types and definitions
+
+// FIFO depth in entries
+#define FIFO_DEPTH 32
+
+// Weight of a shorter latency observation is 1 / 2^LATENCY_SHIFT
+#define LATENCY_SHIFT 3
+
+// microseconds * millihertz per sample
+#define US_MHZ_PER_SAMPLE 1000000000ULL
+
+// =============================================================================
+// local (forward) declarations
+
+static adxl345_err_t retune(adxl345_wmctl_t *ctl);
+
+// =============================================================================
+// local storage
+
+// =============================================================================
+// public code
+
+adxl345_err_t adxl345_wmctl_init(adxl345_wmctl_t *ctl, adxl345_watermark_t *wm,
+                                 uint32_t budget_us,
+                                 adxl345_wmctl_log_fn log_fn, void *log_arg) {
+  ctl->wm = wm;
+  ctl->odr_mhz = 0;
+  ctl->budget_us = budget_us;
+  ctl->latency_us = 0;
+  ctl->min_level = 1;
+  ctl->max_level = ADXL345_WATERMARK_MAX;
+  ctl->hysteresis = 2;
+  ctl->has_latency = false;
+  ctl->log_fn = log_fn;
+  ctl->log_arg = log_arg;
+  ctl->adjustments = 0;
+  return adxl345_wmctl_refresh_odr(ctl);
+}
+
+adxl345_err_t adxl345_wmctl_set_limits(adxl345_wmctl_t *ctl, uint8_t min_level,
+                                       uint8_t max_level, uint8_t hysteresis) {
+  if ((min_level == 0) || (min_level > max_level) ||
+      (max_level > ADXL345_WATERMARK_MAX)) {
+    return ADXL345_ERR_PARAM;
+  }
+  ctl->min_level = min_level;
+  ctl->max_level = max_level;
+  ctl->hysteresis = hysteresis;
+  return retune(ctl);
+}
+
+adxl345_err_t adxl345_wmctl_set_budget(adxl345_wmctl_t *ctl,
+                                       uint32_t budget_us) {
+  ctl->budget_us = budget_us;
+  return retune(ctl);
+}
+
+adxl345_err_t adxl345_wmctl_refresh_odr(adxl345_wmctl_t *ctl) {
+  adxl345_err_t err = adxl345_get_rate_mhz(ctl->wm->adxl345, &ctl->odr_mhz);
+  if (err != ADXL345_ERR_NONE) return err;
+  return retune(ctl);
+}
+
+adxl345_err_t adxl345_wmctl_observe(adxl345_wmctl_t *ctl,
+                                    uint32_t latency_us) {
+  if (!ctl->has_latency) {
+    ctl->latency_us = latency_us;
+    ctl->has_latency = true;
+  } else if (latency_us > ctl->latency_us) {
+    // react quickly to slower service: that is when samples get old.
+    ctl->latency_us += (latency_us - ctl->latency_us + 1) / 2;
+  } else {
+    ctl->latency_us -= (ctl->latency_us - latency_us) >> LATENCY_SHIFT;
+  }
+  return retune(ctl);
+}
+
+uint8_t adxl345_wmctl_target(const adxl345_wmctl_t *ctl) {
+  uint64_t slack_us;
+  uint64_t level;
+  uint64_t in_flight;
+
+  if (ctl->budget_us > ctl->latency_us) {
+    slack_us = ctl->budget_us - ctl->latency_us;
+  } else {
+    slack_us = 0;
+  }
+
+  // largest level whose oldest sample still meets the budget
+  level = 1 + (slack_us * ctl->odr_mhz) / US_MHZ_PER_SAMPLE;
+
+  // samples arriving while the drain is in progress must fit in the FIFO
+  in_flight = ((uint64_t)ctl->latency_us * ctl->odr_mhz + US_MHZ_PER_SAMPLE -
+               1) / US_MHZ_PER_SAMPLE;
+  if (level + in_flight > FIFO_DEPTH - 1) {
+    level = (in_flight < FIFO_DEPTH - 1) ? FIFO_DEPTH - 1 - in_flight : 0;
+  }
+
+  if (level < ctl->min_level) level = ctl->min_level;
+  if (level > ctl->max_level) level = ctl->max_level;
+  return (uint8_t)level;
+}
+
+// =============================================================================
+// local (static) code
+
+static adxl345_err_t retune(adxl345_wmctl_t *ctl) {
+  adxl345_wmctl_decision_t decision;
+  uint8_t current = ctl->wm->watermark;
+  uint8_t target = adxl345_wmctl_target(ctl);
+  adxl345_err_t err;
+
+  // shrink at once to protect latency; only grow when it is worth a write.
+  if (target == current) return ADXL345_ERR_NONE;
+  if ((target > current) && (target - current < ctl->hysteresis)) {
+    return ADXL345_ERR_NONE;
+  }
+
+  err = adxl345_watermark_set_level(ctl->wm, target);
+  if (err != ADXL345_ERR_NONE) return err;
+
+  ctl->adjustments += 1;
+  if (ctl->log_fn != NULL) {
+    decision.old_level = current;
+    decision.new_level = target;
+    decision.odr_mhz = ctl->odr_mhz;
+    decision.latency_us = ctl->latency_us;
+    decision.budget_us = ctl->budget_us;
+    ctl->log_fn(ctl->log_arg, &decision);
+  }
+  return ADXL345_ERR_NONE;
+}
@@ -0,0 +1,129 @@
+/** @file adxl345_wmctl.h
+ *
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to permit
+ * persons to whom the Software is furnished to do so, subject to the
+ * following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+ * NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+ * USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef _ADXL345_WMCTL_H_
+#define _ADXL345_WMCTL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// includes
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "adxl345_err.h"
+#include "adxl345_watermark.h"
+
+// =============================================================================
+// types and definitions
+
+/**
+ * A record of one watermark change, passed to the log callback.
+ */
+typedef struct {
+  uint8_t old_level;    ///< watermark before the change
+  uint8_t new_level;    ///< watermark after the change
+  uint32_t odr_mhz;     ///< output data rate in effect
+  uint32_t latency_us;  ///< smoothed observed service latency
+  uint32_t budget_us;   ///< latency budget in effect
+} adxl345_wmctl_decision_t;
+
+typedef void (*adxl345_wmctl_log_fn)(void *arg,
+                                     const adxl345_wmctl_decision_t *decision);
+
+/**
+ * Adaptive watermark controller.
+ *
+ * The oldest sample of a batch waits (watermark - 1) sample periods for the
+ * watermark to be reached and then the service latency for the drain, so the
+ * controller picks the largest watermark that keeps
+ *
+ *   (watermark - 1) / ODR + latency <= budget
+ *
+ * while leaving enough FIFO headroom to absorb `latency * ODR` new samples
+ * without overrun.  Larger watermarks mean fewer, longer bursts on the bus.
+ */
+typedef struct {
+  adxl345_watermark_t *wm;      ///< the servicing engine being tuned
+  uint32_t odr_mhz;             ///< output data rate, from BW_RATE
+  uint32_t budget_us;           ///< worst-case sample age allowed
+  uint32_t latency_us;          ///< smoothed service latency
+  uint8_t min_level;            ///< smallest watermark to use
+  uint8_t max_level;            ///< largest watermark to use
+  uint8_t hysteresis;           ///< min increase worth a register write
+  bool has_latency;             ///< true after the first observation
+  adxl345_wmctl_log_fn log_fn;  ///< optional decision log
+  void *log_arg;                ///< passed to log_fn
+  uint32_t adjustments;         ///< number of watermark changes made
+} adxl345_wmctl_t;
+
+// =============================================================================
+// declarations
+
+/**
+ * @brief Initialize the controller and read the current ODR from BW_RATE.
+ *
+ * The watermark engine must already be initialized.  log_fn may be NULL.
+ */
+adxl345_err_t adxl345_wmctl_init(adxl345_wmctl_t *ctl, adxl345_watermark_t *wm,
+                                 uint32_t budget_us,
+                                 adxl345_wmctl_log_fn log_fn, void *log_arg);
+
+/**
+ * @brief Restrict the watermark range and set the hysteresis (default 1..31,
+ * hysteresis 2).
+ */
+adxl345_err_t adxl345_wmctl_set_limits(adxl345_wmctl_t *ctl, uint8_t min_level,
+                                       uint8_t max_level, uint8_t hysteresis);
+
+/**
+ * @brief Change the latency budget and re-tune immediately.
+ */
+adxl345_err_t adxl345_wmctl_set_budget(adxl345_wmctl_t *ctl,
+                                       uint32_t budget_us);
+
+/**
+ * @brief Re-read BW_RATE after the data rate has been changed, and re-tune.
+ */
+adxl345_err_t adxl345_wmctl_refresh_odr(adxl345_wmctl_t *ctl);
+
+/**
+ * @brief Report the latency of one service, from INT assertion to drain
+ * completion, and re-tune.
+ */
+adxl345_err_t adxl345_wmctl_observe(adxl345_wmctl_t *ctl, uint32_t latency_us);
+
+/**
+ * @brief The watermark the controller would choose under current conditions.
+ */
+uint8_t adxl345_wmctl_target(const adxl345_wmctl_t *ctl);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* #ifndef _ADXL345_WMCTL_H_ */
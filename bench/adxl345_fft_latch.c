@@ -0,0 +1,185 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file adxl345_fft_latch.c
+ *
+ * Host check that a completed Welch spectrum stays readable.  Blocks of 256
+ * samples are fed to a 128 point engine with hop 64 and two segments per
+ * average, so every block completes an average and then starts the next
+ * one.  Every feed that reports completion must be followed by a readable
+ * spectrum with the test tone in the expected bin.
+ *
+ * The same is checked through adxl345_envelope, whose feed reports the FFT
+ * engine's completions: a 700 Hz carrier modulated at 100 Hz, decimated by 2
+ * into a 64 point, hop 32 engine, completes two averages per block.
+ */
+
+// =============================================================================
+// includes
+
+#include <math.h>
+#include <stdio.h>
+#include "adxl345_envelope.h"
+#include "adxl345_fft.h"
+
+// =============================================================================
+// local types and definitions
+
+#define PI 3.14159265358979323846
+
+#define FFT_N 128
+#define FFT_HOP 64
+#define FFT_AVERAGE 2
+#define BLOCK 256
+#define BLOCKS 8
+#define TONE_BIN 8
+#define TONE_LSB 1000
+
+#define ENV_FS_HZ 3200.0
+#define ENV_CARRIER_HZ 700.0
+#define ENV_MOD_HZ 100.0
+#define ENV_DECIM 2
+#define ENV_N 64
+#define ENV_HOP 32
+#define ENV_AVERAGE 2
+// 100 Hz / (3200 Hz / (2 * 64))
+#define ENV_MOD_BIN 4
+
+// =============================================================================
+// local (forward) declarations
+
+static void fill_block(adxl345_isample_t *block, uint32_t start);
+
+static void fill_envelope_block(adxl345_isample_t *block, uint32_t start);
+
+static int check_peak(const char *name, adxl345_err_t err,
+                      const uint16_t *mag, uint16_t bins, uint16_t expected,
+                      uint16_t block);
+
+static int run_fft(void);
+
+static int run_envelope(void);
+
+// =============================================================================
+// local storage
+
+static adxl345_fft_t s_fft;
+static adxl345_envelope_t s_env;
+static adxl345_isample_t s_block[BLOCK];
+static uint16_t s_mag[FFT_N / 2];
+
+// =============================================================================
+// public code
+
+int main(void) {
+  if (run_fft() != 0) return 1;
+  return run_envelope();
+}
+
+// =============================================================================
+// local (static) code
+
+static void fill_block(adxl345_isample_t *block, uint32_t start) {
+  for (uint16_t i = 0; i < BLOCK; i++) {
+    double t = (double)(start + i) * TONE_BIN / FFT_N;
+    block[i].x = (int16_t)lround(TONE_LSB * sin(2.0 * PI * t));
+    block[i].y = 0;
+    block[i].z = 256;
+  }
+}
+
+static void fill_envelope_block(adxl345_isample_t *block, uint32_t start) {
+  for (uint16_t i = 0; i < BLOCK; i++) {
+    double t = (double)(start + i) / ENV_FS_HZ;
+    double am = 0.5 * (1.0 + sin(2.0 * PI * ENV_MOD_HZ * t));
+    block[i].x = (int16_t)lround(TONE_LSB * am *
+                                 sin(2.0 * PI * ENV_CARRIER_HZ * t));
+    block[i].y = 0;
+    block[i].z = 256;
+  }
+}
+
+static int check_peak(const char *name, adxl345_err_t err,
+                      const uint16_t *mag, uint16_t bins, uint16_t expected,
+                      uint16_t block) {
+  uint16_t peak = 1;
+
+  if (err != ADXL345_ERR_NONE) {
+    printf("%s: block %u reported a spectrum that cannot be read\n", name,
+           (unsigned)block);
+    return 1;
+  }
+  for (uint16_t k = 1; k < bins; k++) {
+    if (mag[k] > mag[peak]) peak = k;
+  }
+  // expected bin 0 (DC, always removed) skips the peak check
+  if ((expected != 0) && (peak != expected)) {
+    printf("%s: block %u peak in bin %u, expected %u\n", name,
+           (unsigned)block, (unsigned)peak, (unsigned)expected);
+    return 1;
+  }
+  return 0;
+}
+
+static int run_fft(void) {
+  uint16_t spectra = 0;
+
+  adxl345_fft_init(&s_fft, FFT_N, FFT_HOP, FFT_AVERAGE);
+  for (uint16_t b = 0; b < BLOCKS; b++) {
+    adxl345_err_t err;
+    fill_block(s_block, (uint32_t)b * BLOCK);
+    if (!adxl345_fft_feed(&s_fft, s_block, BLOCK)) continue;
+    err = adxl345_fft_spectrum(&s_fft, ADXL345_FFT_X, s_mag);
+    if (check_peak("fft", err, s_mag, FFT_N / 2, TONE_BIN, b) != 0) return 1;
+    spectra += 1;
+  }
+  printf("fft: %u of %u blocks completed a readable spectrum\n",
+         (unsigned)spectra, (unsigned)BLOCKS);
+  return (spectra > 0) ? 0 : 1;
+}
+
+static int run_envelope(void) {
+  adxl345_envelope_config_t config = {
+      ENV_FS_HZ, 500.0f, 900.0f, ENV_DECIM, ENV_N, ENV_HOP, ENV_AVERAGE};
+  uint16_t spectra = 0;
+
+  if (adxl345_envelope_init(&s_env, &config) != ADXL345_ERR_NONE) return 1;
+  for (uint16_t b = 0; b < BLOCKS; b++) {
+    adxl345_err_t err;
+    fill_envelope_block(s_block, (uint32_t)b * BLOCK);
+    if (!adxl345_envelope_feed(&s_env, s_block, BLOCK)) continue;
+    err = adxl345_envelope_spectrum(&s_env, ADXL345_FFT_X, s_mag);
+    // the filters are still settling in the first block, so only check that
+    // its spectrum can be read
+    if (check_peak("envelope", err, s_mag, ENV_N / 2,
+                   (b > 0) ? ENV_MOD_BIN : 0, b) != 0) {
+      return 1;
+    }
+    spectra += 1;
+  }
+  printf("envelope: %u of %u blocks completed a readable spectrum\n",
+         (unsigned)spectra, (unsigned)BLOCKS);
+  return (spectra > 0) ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file adxl345_orient_bench.c
+ *
+ * Host check of adxl345_orient_atan2() against libm: worst-case error over a
+ * 3 LSB grid of the +/-4096 square and over every small vector, then the
+ * time per call of each.  Fails if the error exceeds
+ * ADXL345_ORIENT_MAX_ERROR_CDEG.  Timings are host figures only; on an
+ * FPU-less core atan2f() is soft-float.
+ */
+
+// =============================================================================
+// includes
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#include "adxl345_orient.h"
+
+// =============================================================================
+// local types and definitions
+
+#define PI 3.14159265358979323846
+
+#define GRID_LIMIT 4096
+#define GRID_STEP 3
+#define SMALL_LIMIT 40
+#define TIMING_CALLS 3000000L
+
+// =============================================================================
+// local (forward) declarations
+
+static double error_cdeg(int32_t y, int32_t x);
+
+static double scan(int32_t limit, int32_t step, double worst);
+
+static double time_cordic(void);
+
+static double time_libm(void);
+
+// =============================================================================
+// local storage
+
+static volatile int32_t s_sink;
+static volatile float s_fsink;
+
+// =============================================================================
+// public code
+
+int main(void) {
+  double worst = scan(GRID_LIMIT, GRID_STEP, 0.0);
+
+  worst = scan(SMALL_LIMIT, 1, worst);
+  printf("worst error %.3f cdeg (limit %d)\n", worst,
+         ADXL345_ORIENT_MAX_ERROR_CDEG);
+  printf("cordic %.1f ns/call, atan2f %.1f ns/call\n", time_cordic(),
+         time_libm());
+  return (worst <= ADXL345_ORIENT_MAX_ERROR_CDEG) ? 0 : 1;
+}
+
+// =============================================================================
+// local (static) code
+
+static double error_cdeg(int32_t y, int32_t x) {
+  double ref = atan2((double)y, (double)x) * 18000.0 / PI;
+  double e = fabs(adxl345_orient_atan2(y, x) - ref);
+
+  // +18000 and -18000 are the same direction
+  return (e > 18000.0) ? fabs(e - 36000.0) : e;
+}
+
+static double scan(int32_t limit, int32_t step, double worst) {
+  for (int32_t y = -limit; y <= limit; y += step) {
+    for (int32_t x = -limit; x <= limit; x += step) {
+      double e;
+      if ((x == 0) && (y == 0)) continue;
+      e = error_cdeg(y, x);
+      if (e > worst) worst = e;
+    }
+  }
+  return worst;
+}
+
+static double time_cordic(void) {
+  clock_t start = clock();
+
+  for (long i = 0; i < TIMING_CALLS; i++) {
+    s_sink += adxl345_orient_atan2(i & 4095, 2000 - (i & 2047));
+  }
+  return (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / TIMING_CALLS;
+}
+
+static double time_libm(void) {
+  clock_t start = clock();
+
+  for (long i = 0; i < TIMING_CALLS; i++) {
+    s_fsink += atan2f((float)(i & 4095), (float)(2000 - (i & 2047)));
+  }
+  return (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / TIMING_CALLS;
+}
@@ -0,0 +1,107 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file adxl345_ts_drift.c
+ *
+ * Host simulation of adxl345_ts against a part whose true ODR is 103 Hz
+ * while the nominal setting is 100 Hz.  The FIFO is drained every 32 samples
+ * for 100 minutes, each drain stamped 5.0 to 5.2 ms after its newest sample
+ * (a fixed interrupt latency plus uniform jitter).  Reports the estimated
+ * ODR and the worst timestamp error once the fit has settled, and fails if
+ * that error exceeds the jitter.
+ */
+
+// =============================================================================
+// includes
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "adxl345_ts.h"
+
+// =============================================================================
+// local types and definitions
+
+#define NOMINAL_ODR_MHZ 100000
+#define TRUE_ODR_HZ 103.0
+#define MIN_SPACING_US 500000
+#define DRAIN_ENTRIES 32
+#define RUN_SECONDS (100.0 * 60.0)
+#define LATENCY_US 5000
+#define JITTER_US 200
+#define SETTLE_DRAINS 100
+
+// =============================================================================
+// local (forward) declarations
+
+static uint32_t jitter_us(void);
+
+// =============================================================================
+// local storage
+
+static uint32_t s_lcg = 1;
+
+// =============================================================================
+// public code
+
+int main(void) {
+  adxl345_ts_t ts;
+  double period_us = 1e6 / TRUE_ODR_HZ;
+  uint32_t drains = (uint32_t)(RUN_SECONDS * TRUE_ODR_HZ / DRAIN_ENTRIES);
+  uint32_t seq = 0;
+  double worst = 0.0;
+
+  adxl345_ts_init(&ts, NOMINAL_ODR_MHZ, MIN_SPACING_US);
+
+  for (uint32_t i = 0; i < drains; i++) {
+    uint32_t newest = seq + DRAIN_ENTRIES - 1;
+    double taken_us = newest * period_us;
+    uint64_t now_us = (uint64_t)(taken_us + LATENCY_US + jitter_us());
+
+    adxl345_ts_anchor(&ts, seq, DRAIN_ENTRIES, now_us);
+    if (i >= SETTLE_DRAINS) {
+      // the fit cannot see the constant latency, only its mean
+      double expected = taken_us + LATENCY_US + JITTER_US / 2.0;
+      double err = fabs((double)adxl345_ts_time_of(&ts, newest) - expected);
+      if (err > worst) worst = err;
+    }
+    seq += DRAIN_ENTRIES;
+  }
+
+  printf("%u drains, estimated ODR %.3f Hz, worst error %.1f us "
+         "(jitter %d us)\n",
+         (unsigned)drains, adxl345_ts_odr_mhz(&ts) / 1000.0, worst,
+         JITTER_US);
+  return (worst <= JITTER_US) ? 0 : 1;
+}
+
+// =============================================================================
+// local (static) code
+
+static uint32_t jitter_us(void) {
+  // fixed LCG so every run sees the same jitter
+  s_lcg = s_lcg * 1103515245UL + 12345UL;
+  return (s_lcg >> 16) % JITTER_US;
+}
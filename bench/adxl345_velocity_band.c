@@ -0,0 +1,151 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2020 R. Dunbar Poor <rdpoor@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file adxl345_velocity_band.c
+ *
+ * Host check of the velocity integrator's gain across the band.  Sines of
+ * 1000 LSB from 20 Hz to 0.375 fs are fed at fs = 3200 Hz with only the 10 Hz
+ * high-pass in the chain, and the velocity RMS is compared with the exact
+ * integral after that high-pass.  Fails if any reading is off by more than
+ * 2%, or if a band edge above ADXL345_VELOCITY_MAX_BAND * fs is accepted.
+ */
+
+// =============================================================================
+// includes
+
+#include <math.h>
+#include <stdio.h>
+#include "adxl345_velocity.h"
+
+// =============================================================================
+// local types and definitions
+
+#define PI 3.14159265358979323846
+
+#define FS_HZ 3200.0
+#define LO_HZ 10.0
+#define AMPLITUDE_LSB 1000.0
+#define SETTLE_SECONDS 2
+#define WINDOW 3200
+#define MAX_ERROR 0.02
+
+// full resolution, datasheet typical, as in adxl345_velocity.c
+#define MM_S2_PER_LSB (0.0039 * 9806.65)
+
+// =============================================================================
+// local (forward) declarations
+
+static double measure(double f_hz);
+
+static double expected(double f_hz);
+
+// =============================================================================
+// local storage
+
+static const double s_freqs_hz[] = {20, 50, 100, 200, 400, 600,
+                                    800, 1000, 1100, 1200};
+
+static adxl345_velocity_t s_vel;
+
+// =============================================================================
+// public code
+
+int main(void) {
+  adxl345_velocity_config_t config = {FS_HZ, LO_HZ, 1300.0f, ADXL345_FULL_RES,
+                                      WINDOW};
+  double worst = 0.0;
+
+  if (adxl345_velocity_init(&s_vel, &config) != ADXL345_ERR_PARAM) {
+    printf("velocity: hi_hz 1300 at fs 3200 was accepted\n");
+    return 1;
+  }
+
+  for (size_t i = 0; i < sizeof(s_freqs_hz) / sizeof(s_freqs_hz[0]); i++) {
+    double f = s_freqs_hz[i];
+    double got = measure(f);
+    double want = expected(f);
+    double err = got / want - 1.0;
+
+    printf("%6.0f Hz: %7.3f mm/s, expected %7.3f (%+.2f%%)\n", f, got, want,
+           err * 100.0);
+    if (fabs(err) > worst) worst = fabs(err);
+  }
+  return (worst <= MAX_ERROR) ? 0 : 1;
+}
+
+// adxl345.c is linked for adxl345_format_shift(); there is no device
+
+adxl345_err_t adxl345_dev_read_reg(adxl345_dev_t *dev, uint8_t saddr,
+                                   uint8_t *dst) {
+  (void)dev;
+  (void)saddr;
+  (void)dst;
+  return ADXL345_ERR_IO;
+}
+
+adxl345_err_t adxl345_dev_write_reg(adxl345_dev_t *dev, uint8_t addr,
+                                    uint8_t val) {
+  (void)dev;
+  (void)addr;
+  (void)val;
+  return ADXL345_ERR_IO;
+}
+
+adxl345_err_t adxl345_dev_read_regs(adxl345_dev_t *dev, uint8_t start_addr,
+                                    uint8_t *dst, uint8_t n_bytes) {
+  (void)dev;
+  (void)start_addr;
+  (void)dst;
+  (void)n_bytes;
+  return ADXL345_ERR_IO;
+}
+
+// =============================================================================
+// local (static) code
+
+static double measure(double f_hz) {
+  adxl345_velocity_config_t config = {FS_HZ, LO_HZ, 0.0f, ADXL345_FULL_RES,
+                                      WINDOW};
+  uint32_t total = (SETTLE_SECONDS + 1) * (uint32_t)FS_HZ;
+  adxl345_isample_t s;
+
+  adxl345_velocity_init(&s_vel, &config);
+  for (uint32_t i = 0; i < total; i++) {
+    s.x = (int16_t)lround(AMPLITUDE_LSB * sin(2.0 * PI * f_hz * i / FS_HZ));
+    s.y = 0;
+    s.z = 0;
+    adxl345_velocity_feed(&s_vel, &s, 1);
+  }
+  return s_vel.result[0].rms_mm_s;
+}
+
+static double expected(double f_hz) {
+  // 2nd order Butterworth high-pass gain, then 1 / (2 pi f)
+  double r = f_hz / LO_HZ;
+  double hp = r * r / sqrt(1.0 + r * r * r * r);
+  double accel = AMPLITUDE_LSB / sqrt(2.0) * MM_S2_PER_LSB;
+
+  return accel * hp / (2.0 * PI * f_hz);
+}